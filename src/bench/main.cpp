@@ -0,0 +1,575 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: main.cpp
+ *  Headless benchmark of the physics and surface passes of ClothSim
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: Every configuration is restarted, settled for a number of steps (so
+ *  the cloth is draping instead of lying flat and satisfied), run through a
+ *  few discarded warm-up repetitions and then timed for --reps repetitions.
+ *  A repetition times each phase over steps_per_rep calls, where small cloths
+ *  take more steps so a repetition lasts long enough to time reliably.
+ *
+ *  For each configuration (side count n, solver, iterations, fixed points)
+ *  and phase the JSON output holds the ns/step distribution over the
+ *  repetitions (min, median, mean, stddev, max) plus the median divided by
+ *  the vertex count (ns_per_vertex) and by the active constraint count
+ *  (ns_per_constraint), counted after each timed repetition and averaged, so
+ *  edges torn during the run (--tearing) are not counted. update_physics also reports ns_per_projection, the
+ *  median divided by constraints * iterations * substeps. With --tolerance
+ *  the iteration count is only a cap, so every result also holds the mean
+ *  sweeps per step actually run (mean_iterations, see ClothSim::step_stats)
+ *  and ns_per_projection divides by those instead.
+ *
+ *  The sweep runs the iteration counts for every solver with the Curtain
+ *  arrangement, then every fixed point arrangement with the default solver
+ *  and the first requested iteration count.
+ * ---------------------------------------------------------------------------- */
+
+#include "../physics/cloth_sim.h"
+#include "../physics/cloth_surface.h"
+#include "../physics/constraint_kernel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+typedef ClothSim::size_type size_type;
+
+// global constants
+const size_type DEFAULT_SIZES[] = {32, 64, 128, 256, 512, 1024};
+const size_type DEFAULT_ITERATIONS[] = {4, 16, 64};
+const size_type DEFAULT_REPS = 7;
+const size_type DEFAULT_WARMUP = 2;
+const size_type DEFAULT_SETTLE_STEPS = 16;
+// - steps_per_rep = max(1, STEP_VERTEX_BUDGET/n^2)
+const size_type STEP_VERTEX_BUDGET = 1 << 16;
+const float CLOTH_SCALE = 2.0f;
+
+const char* const FPA_NAMES[] = {
+    "Curtain", "FlagLeft", "FlatRight", "FourCorners", "AllTop",
+    "AllLeft", "AllRight", "AllLeftRight", "AllPerimeter", "Loose"
+};
+const size_type FPA_COUNT = sizeof(FPA_NAMES)/sizeof(FPA_NAMES[0]);
+const char* const STRATEGY_NAMES[] = {
+    "GaussSeidel", "Colored", "Tiled", "Multigrid", "Jacobi"
+};
+const size_type STRATEGY_COUNT = sizeof(STRATEGY_NAMES)/sizeof(STRATEGY_NAMES[0]);
+const char* const MODEL_NAMES[] = {
+    "FlexBand", "Xpbd"
+};
+const size_type MODEL_COUNT = sizeof(MODEL_NAMES)/sizeof(MODEL_NAMES[0]);
+const char* const INTEGRATOR_NAMES[] = {
+    "Verlet", "ProjectiveDynamics", "ImplicitEuler"
+};
+const size_type INTEGRATOR_COUNT = sizeof(INTEGRATOR_NAMES)/sizeof(INTEGRATOR_NAMES[0]);
+const char* const ISA_NAMES[] = {
+    "Scalar", "SSE2", "AVX2"
+};
+
+// structs
+struct bench_options {
+    std::vector<size_type> sizes;
+    std::vector<size_type> iterations;
+    std::vector<ClothSim::SolverStrategy> strategies;
+    size_type reps;
+    size_type warmup;
+    size_type settle_steps;
+    size_type threads;
+    ClothSim::ConstraintModel model;
+    ClothSim::Integrator integrator;
+    float time_step;
+    size_type substeps;
+    float tolerance; // 0 runs a fixed iteration count
+    float spectral_radius; // 0 disables chebyshev acceleration
+    bool attachments;
+    bool tearing;
+    bool self_collision;
+    size_type colliders;
+    size_type mesh_triangles;
+    std::string out_path;
+};
+struct bench_config {
+    size_type n;
+    size_type iterations;
+    ClothSim::FixedPointArrangement fpa;
+    ClothSim::SolverStrategy strategy;
+};
+struct phase_stats {
+    double min;
+    double median;
+    double mean;
+    double stddev;
+    double max;
+};
+struct bench_result {
+    bench_config config;
+    size_type vertices;
+    double constraints; // active, averaged over the timed repetitions
+    size_type steps_per_rep;
+    double mean_iterations; // sweeps per step, over every substep
+    phase_stats physics;
+    phase_stats normals;
+    phase_stats mesh;
+};
+
+
+
+/* ============================================================================ *
+ * Timing
+ * ============================================================================ */
+typedef std::chrono::steady_clock bench_clock;
+
+double elapsed_ns(const bench_clock::time_point& start) {
+    return std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+}
+
+phase_stats compute_stats(std::vector<double> samples) {
+    phase_stats s;
+    std::sort(samples.begin(), samples.end());
+    size_type k = samples.size();
+    s.min = samples.front();
+    s.max = samples.back();
+    s.median = (k & 1) ? samples[k/2] : 0.5*(samples[k/2-1] + samples[k/2]);
+    double sum = 0;
+    for(auto it=samples.begin(); it!=samples.end(); ++it)
+        sum += *it;
+    s.mean = sum/k;
+    double var = 0;
+    for(auto it=samples.begin(); it!=samples.end(); ++it)
+        var += (*it - s.mean)*(*it - s.mean);
+    s.stddev = k > 1 ? std::sqrt(var/(k-1)) : 0;
+    return s;
+}
+
+size_type count_active_constraints(const ClothSim& sim) {
+    size_type count = 0;
+    const std::vector<ClothSim::cloth_edge>& edges = sim.get_edges();
+    for(auto it=edges.begin(); it!=edges.end(); ++it)
+        count += it->active;
+    return count;
+}
+
+
+
+// a grid of k spheres over the rest cloth, each pushing into it by half its
+// radius
+void add_colliders(ClothSim& sim, size_type k) {
+    size_type cols = 1;
+    while(cols*cols < k)
+        cols++;
+    float radius = 0.5f*CLOTH_SCALE/cols;
+    for(size_type i=0; i<k; i++) {
+        glm::vec3 center(CLOTH_SCALE*(i%cols + 0.5f)/cols, -CLOTH_SCALE*(i/cols + 0.5f)/cols, 0.5f*radius);
+        sim.add_collider(physics::make_sphere_collider(center, radius, ClothSim::FLOOR_PLANE_FRICTION_COEFF));
+    }
+}
+
+// a uv sphere of about k triangles over the middle of the rest cloth,
+// pushing into it by half its radius
+void add_mesh_collider(ClothSim& sim, size_type k) {
+    if(k == 0)
+        return;
+    size_type rings = 2;
+    while(2*rings*(2*rings) < k)
+        rings++;
+    size_type segments = 2*rings;
+    float radius = 0.25f*CLOTH_SCALE;
+    glm::vec3 center(0.5f*CLOTH_SCALE, -0.5f*CLOTH_SCALE, 0.5f*radius);
+    std::vector<glm::vec3> vertices;
+    std::vector<std::uint32_t> indices;
+    for(size_type i=0; i<=rings; i++) {
+        float theta = (float)M_PI*i/rings;
+        for(size_type j=0; j<=segments; j++) {
+            float phi = 2*(float)M_PI*j/segments;
+            vertices.push_back(center + radius*glm::vec3(std::sin(theta)*std::cos(phi), std::cos(theta), std::sin(theta)*std::sin(phi)));
+        }
+    }
+    // counterclockwise seen from outside
+    for(size_type i=0; i<rings; i++) {
+        for(size_type j=0; j<segments; j++) {
+            std::uint32_t a = i*(segments + 1) + j;
+            std::uint32_t c = a + segments + 1;
+            indices.insert(indices.end(), {a, a + 1, c, a + 1, c + 1, c});
+        }
+    }
+    sim.add_mesh_collider(vertices, indices, ClothSim::FLOOR_PLANE_FRICTION_COEFF);
+}
+
+
+
+/* ============================================================================ *
+ * Benchmark
+ * ============================================================================ */
+bench_result run_config(ClothSim& sim, const bench_config& config, const bench_options& opts) {
+    sim.set_n_vertices(config.n);
+    sim.set_fixed_point_arrangement(config.fpa);
+    sim.set_solver_strategy(config.strategy);
+    sim.set_phys_iterations(config.iterations);
+    sim.restart();
+
+    bench_result result;
+    result.config = config;
+    result.vertices = config.n*config.n;
+    result.steps_per_rep = std::max<size_type>(1, STEP_VERTEX_BUDGET/result.vertices);
+
+    std::vector<glm::vec3> normals;
+    std::vector<physics::surface_vertex> mesh(physics::max_triangle_vertices(sim));
+
+    for(size_type i=0; i<opts.settle_steps; i++)
+        sim.update_physics();
+
+    std::vector<double> t_physics, t_normals, t_mesh;
+    size_type steps = result.steps_per_rep;
+    size_type sweeps = 0;
+    size_type constraints = 0;
+    for(size_type rep=0; rep<opts.warmup+opts.reps; rep++) {
+        size_type rep_sweeps = 0;
+        bench_clock::time_point start = bench_clock::now();
+        for(size_type i=0; i<steps; i++) {
+            sim.update_physics();
+            rep_sweeps += sim.get_step_stats().iterations;
+        }
+        double ns_physics = elapsed_ns(start)/steps;
+
+        start = bench_clock::now();
+        for(size_type i=0; i<steps; i++)
+            physics::compute_normals(sim, normals);
+        double ns_normals = elapsed_ns(start)/steps;
+
+        start = bench_clock::now();
+        volatile size_type sink = 0;
+        for(size_type i=0; i<steps; i++)
+            sink = physics::compute_triangles(sim, normals, mesh.data());
+        (void)sink;
+        double ns_mesh = elapsed_ns(start)/steps;
+
+        if(rep >= opts.warmup) {
+            sweeps += rep_sweeps;
+            constraints += count_active_constraints(sim);
+            t_physics.push_back(ns_physics);
+            t_normals.push_back(ns_normals);
+            t_mesh.push_back(ns_mesh);
+        }
+    }
+    result.mean_iterations = (double)sweeps/(steps*opts.reps);
+    result.constraints = (double)constraints/opts.reps;
+    result.physics = compute_stats(t_physics);
+    result.normals = compute_stats(t_normals);
+    result.mesh = compute_stats(t_mesh);
+    return result;
+}
+
+std::vector<bench_config> build_sweep(const bench_options& opts) {
+    std::vector<bench_config> configs;
+    for(auto n=opts.sizes.begin(); n!=opts.sizes.end(); ++n) {
+        // iteration sweep, per solver
+        for(auto s=opts.strategies.begin(); s!=opts.strategies.end(); ++s) {
+            for(auto it=opts.iterations.begin(); it!=opts.iterations.end(); ++it)
+                configs.push_back({*n, *it, ClothSim::Curtain, *s});
+        }
+        // fixed point sweep (Curtain is covered above)
+        for(size_type f=1; f<FPA_COUNT; f++) {
+            configs.push_back({*n, opts.iterations.front(),
+                (ClothSim::FixedPointArrangement)f, opts.strategies.front()});
+        }
+    }
+    return configs;
+}
+
+
+
+/* ============================================================================ *
+ * Output
+ * ============================================================================ */
+void write_stats(std::ostream& out, const phase_stats& s) {
+    out << "{\"min\": " << s.min
+        << ", \"median\": " << s.median
+        << ", \"mean\": " << s.mean
+        << ", \"stddev\": " << s.stddev
+        << ", \"max\": " << s.max << "}";
+}
+
+void write_phase(std::ostream& out, const char* name, const phase_stats& s, const bench_result& r, double projections) {
+    out << "        \"" << name << "\": {\"ns_per_step\": ";
+    write_stats(out, s);
+    out << ", \"ns_per_vertex\": " << s.median/r.vertices
+        << ", \"ns_per_constraint\": " << (r.constraints ? s.median/r.constraints : 0);
+    if(projections)
+        out << ", \"ns_per_projection\": " << s.median/projections;
+    out << "}";
+}
+
+void write_json(std::ostream& out, const bench_options& opts, const std::vector<bench_result>& results) {
+    out.precision(6);
+    out << "{\n"
+        << "  \"benchmark\": \"clothsim-physics\",\n"
+        << "  \"kernel_isa\": \"" << ISA_NAMES[physics::get_kernel_isa()] << "\",\n"
+        << "  \"threads\": " << opts.threads << ",\n"
+        << "  \"constraint_model\": \"" << MODEL_NAMES[opts.model] << "\",\n"
+        << "  \"integrator\": \"" << INTEGRATOR_NAMES[opts.integrator] << "\",\n"
+        << "  \"time_step\": " << opts.time_step << ",\n"
+        << "  \"substeps\": " << opts.substeps << ",\n"
+        << "  \"tolerance\": " << opts.tolerance << ",\n"
+        << "  \"spectral_radius\": " << opts.spectral_radius << ",\n"
+        << "  \"long_range_attachments\": " << (opts.attachments ? "true" : "false") << ",\n"
+        << "  \"tearing\": " << (opts.tearing ? "true" : "false") << ",\n"
+        << "  \"self_collision\": " << (opts.self_collision ? "true" : "false") << ",\n"
+        << "  \"colliders\": " << opts.colliders << ",\n"
+        << "  \"mesh_triangles\": " << opts.mesh_triangles << ",\n"
+        << "  \"reps\": " << opts.reps << ",\n"
+        << "  \"warmup\": " << opts.warmup << ",\n"
+        << "  \"settle_steps\": " << opts.settle_steps << ",\n"
+        << "  \"results\": [\n";
+    for(size_type i=0; i<results.size(); i++) {
+        const bench_result& r = results[i];
+        out << "    {\"n\": " << r.config.n
+            << ", \"vertices\": " << r.vertices
+            << ", \"constraints\": " << r.constraints
+            << ", \"iterations\": " << r.config.iterations
+            << ", \"strategy\": \"" << STRATEGY_NAMES[r.config.strategy] << "\""
+            << ", \"fixed_points\": \"" << FPA_NAMES[r.config.fpa] << "\""
+            << ", \"steps_per_rep\": " << r.steps_per_rep
+            << ", \"mean_iterations\": " << r.mean_iterations
+            << ",\n      \"phases\": {\n";
+        write_phase(out, "update_physics", r.physics, r, r.constraints*r.mean_iterations);
+        out << ",\n";
+        write_phase(out, "compute_normals", r.normals, r, 0);
+        out << ",\n";
+        write_phase(out, "compute_mesh", r.mesh, r, 0);
+        out << "\n      }}" << (i+1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+
+
+/* ============================================================================ *
+ * Argument Parsing
+ * ============================================================================ */
+std::vector<size_type> parse_list(const std::string& arg) {
+    std::vector<size_type> values;
+    std::stringstream ss(arg);
+    std::string item;
+    while(std::getline(ss, item, ','))
+        values.push_back(std::strtoul(item.c_str(), nullptr, 10));
+    return values;
+}
+
+bool parse_strategy(const std::string& name, ClothSim::SolverStrategy& strategy) {
+    for(size_type s=0; s<STRATEGY_COUNT; s++) {
+        if(name == STRATEGY_NAMES[s]) {
+            strategy = (ClothSim::SolverStrategy)s;
+            return true;
+        }
+    }
+    return false;
+}
+
+void print_usage(const char* prog) {
+    cerr << "usage: " << prog << " [options]\n"
+         << "  --sizes a,b,...       side vertex counts (default 32,...,1024)\n"
+         << "  --iterations a,b,...  solver iterations (default 4,16,64)\n"
+         << "  --strategies a,b,...  GaussSeidel,Colored,Tiled,Multigrid,\n"
+         << "                        Jacobi (default all)\n"
+         << "  --reps k              timed repetitions (default " << DEFAULT_REPS << ")\n"
+         << "  --warmup k            discarded repetitions (default " << DEFAULT_WARMUP << ")\n"
+         << "  --settle k            steps before warm-up (default " << DEFAULT_SETTLE_STEPS << ")\n"
+         << "  --threads k           solver threads (default 1)\n"
+         << "  --model name          FlexBand or Xpbd (default FlexBand)\n"
+         << "  --integrator name     Verlet, ProjectiveDynamics or ImplicitEuler\n"
+         << "                        (default Verlet)\n"
+         << "  --time-step s         seconds per step (default 1/60)\n"
+         << "  --substeps k          substeps per step (default 1)\n"
+         << "  --tolerance e         adaptive iterations, capped by --iterations,\n"
+         << "                        until the max error is within e (default off)\n"
+         << "  --chebyshev rho       accelerate the sweeps with spectral radius rho\n"
+         << "                        (default off)\n"
+         << "  --lra                 long-range attachments to the pins\n"
+         << "  --tearing             tear overstretched edges\n"
+         << "  --self-collision      collide the cloth with itself\n"
+         << "  --colliders k         k spheres pressing into the cloth (default 0)\n"
+         << "  --mesh-collider k     a triangle mesh sphere of about k triangles\n"
+         << "                        pressing into the cloth (default none)\n"
+         << "  --quick               sizes 32,64,128 and 2 reps\n"
+         << "  --out path            write JSON to path instead of stdout\n";
+}
+
+bool parse_args(int argc, char* argv[], bench_options& opts) {
+    opts.sizes.assign(DEFAULT_SIZES, DEFAULT_SIZES + sizeof(DEFAULT_SIZES)/sizeof(DEFAULT_SIZES[0]));
+    opts.iterations.assign(DEFAULT_ITERATIONS, DEFAULT_ITERATIONS + sizeof(DEFAULT_ITERATIONS)/sizeof(DEFAULT_ITERATIONS[0]));
+    for(size_type s=0; s<STRATEGY_COUNT; s++)
+        opts.strategies.push_back((ClothSim::SolverStrategy)s);
+    opts.reps = DEFAULT_REPS;
+    opts.warmup = DEFAULT_WARMUP;
+    opts.settle_steps = DEFAULT_SETTLE_STEPS;
+    opts.threads = 1;
+    opts.model = ClothSim::FlexBand;
+    opts.integrator = ClothSim::Verlet;
+    opts.time_step = ClothSim::DEFAULT_TIME_STEP;
+    opts.substeps = 1;
+    opts.tolerance = 0;
+    opts.spectral_radius = 0;
+    opts.attachments = false;
+    opts.tearing = false;
+    opts.self_collision = false;
+    opts.colliders = 0;
+    opts.mesh_triangles = 0;
+
+    for(int i=1; i<argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i+1 < argc;
+        if(arg == "--quick") {
+            opts.sizes = {32, 64, 128};
+            opts.reps = 2;
+        }
+        else if(arg == "--sizes" && has_value)
+            opts.sizes = parse_list(argv[++i]);
+        else if(arg == "--iterations" && has_value)
+            opts.iterations = parse_list(argv[++i]);
+        else if(arg == "--strategies" && has_value) {
+            opts.strategies.clear();
+            std::stringstream ss(argv[++i]);
+            std::string item;
+            ClothSim::SolverStrategy strategy;
+            while(std::getline(ss, item, ',')) {
+                if(!parse_strategy(item, strategy)) {
+                    cerr << "unknown strategy: " << item << endl;
+                    return false;
+                }
+                opts.strategies.push_back(strategy);
+            }
+        }
+        else if(arg == "--reps" && has_value)
+            opts.reps = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--warmup" && has_value)
+            opts.warmup = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--settle" && has_value)
+            opts.settle_steps = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--threads" && has_value)
+            opts.threads = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--model" && has_value) {
+            std::string name = argv[++i];
+            size_type m = 0;
+            while(m < MODEL_COUNT && name != MODEL_NAMES[m])
+                m++;
+            if(m == MODEL_COUNT) {
+                cerr << "unknown constraint model: " << name << endl;
+                return false;
+            }
+            opts.model = (ClothSim::ConstraintModel)m;
+        }
+        else if(arg == "--integrator" && has_value) {
+            std::string name = argv[++i];
+            size_type k = 0;
+            while(k < INTEGRATOR_COUNT && name != INTEGRATOR_NAMES[k])
+                k++;
+            if(k == INTEGRATOR_COUNT) {
+                cerr << "unknown integrator: " << name << endl;
+                return false;
+            }
+            opts.integrator = (ClothSim::Integrator)k;
+        }
+        else if(arg == "--time-step" && has_value)
+            opts.time_step = std::strtof(argv[++i], nullptr);
+        else if(arg == "--substeps" && has_value)
+            opts.substeps = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--tolerance" && has_value)
+            opts.tolerance = std::strtof(argv[++i], nullptr);
+        else if(arg == "--chebyshev" && has_value)
+            opts.spectral_radius = std::strtof(argv[++i], nullptr);
+        else if(arg == "--lra")
+            opts.attachments = true;
+        else if(arg == "--tearing")
+            opts.tearing = true;
+        else if(arg == "--self-collision")
+            opts.self_collision = true;
+        else if(arg == "--colliders" && has_value)
+            opts.colliders = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--mesh-collider" && has_value)
+            opts.mesh_triangles = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--out" && has_value)
+            opts.out_path = argv[++i];
+        else
+            return false;
+    }
+    // every size needs at least one quad and every config one timed rep
+    for(auto it=opts.sizes.begin(); it!=opts.sizes.end(); ++it) {
+        if(*it < 2)
+            return false;
+    }
+    return !opts.sizes.empty() && !opts.iterations.empty()
+        && !opts.strategies.empty() && opts.reps > 0;
+}
+
+
+
+/* ============================================================================ *
+ * Main
+ * ============================================================================ */
+int main(int argc, char* argv[]) {
+    bench_options opts;
+    if(!parse_args(argc, argv, opts)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    ClothSim sim(CLOTH_SCALE, opts.sizes.front());
+    sim.set_num_threads(opts.threads);
+    sim.set_constraint_model(opts.model);
+    sim.set_integrator(opts.integrator);
+    sim.set_time_step(opts.time_step);
+    sim.set_substeps(opts.substeps);
+    if(opts.tolerance > 0) {
+        sim.set_adaptive_iterations(true);
+        sim.set_error_tolerance(opts.tolerance);
+    }
+    sim.set_long_range_attachments(opts.attachments);
+    sim.set_tearing(opts.tearing);
+    sim.set_self_collision(opts.self_collision);
+    add_colliders(sim, opts.colliders);
+    add_mesh_collider(sim, opts.mesh_triangles);
+    if(opts.spectral_radius > 0) {
+        sim.set_chebyshev_acceleration(true);
+        sim.set_spectral_radius(opts.spectral_radius);
+    }
+
+    std::vector<bench_config> configs = build_sweep(opts);
+    std::vector<bench_result> results;
+    for(size_type i=0; i<configs.size(); i++) {
+        const bench_config& c = configs[i];
+        cerr << "[" << i+1 << "/" << configs.size() << "] n=" << c.n
+             << " iterations=" << c.iterations
+             << " strategy=" << STRATEGY_NAMES[c.strategy]
+             << " fixed_points=" << FPA_NAMES[c.fpa] << endl;
+        results.push_back(run_config(sim, c, opts));
+    }
+
+    if(opts.out_path.empty()) {
+        write_json(cout, opts, results);
+    }
+    else {
+        std::ofstream out(opts.out_path);
+        if(!out) {
+            cerr << "could not open " << opts.out_path << endl;
+            return 1;
+        }
+        write_json(out, opts, results);
+    }
+    return 0;
+}
@@ -16,94 +16,43 @@
 #include "../../lib/glm/mat4x4.hpp"
 
 #include "render_mesh.h"
+#include "../physics/cloth_sim.h"
 #include "../gui/component-interface/gui-component.h"
 #include "../snapshots/int-snapshot.h"
 
 #include <vector>
-#include <set>
 #include <string>
 
+/* ---------------------------------------------------------------------------- *
+ * NOTE: Cloth is the GUI adapter around a headless ClothSim. It owns the
+ *  camera, mouse interaction and rendering; all physics is forwarded.
+ * ---------------------------------------------------------------------------- */
+
 class Cloth : public GuiComponent {
 public:
     // typdefs
-    typedef std::size_t size_type;
+    typedef ClothSim::size_type size_type;
+    typedef ClothSim::FixedPointArrangement FixedPointArrangement;
+    typedef ClothSim::SolverStrategy SolverStrategy;
+    typedef ClothSim::ConstraintModel ConstraintModel;
 
-public:
     // static constants
-    static const size_type DEFAULT_SIDE_VERTEX_COUNT;
-    static const size_type PHYSICS_ITERATIONS;
-    static const float DEFAULT_TIME_STEP;
-    static const float NEIGHBOR_FLEX_COEFF;
-    static const float BENDING_FLEX_COEFF;
-    static const float NEIGHBOR_TEAR_THRESH;
-    static const float FLOOR_PLANE_Y;
-    static const float FLOOR_PLANE_FRICTION_COEFF;
-
-    // enums
-    enum FixedPointArrangement {
-        Curtain=0,
-        FlagLeft,
-        FlatRight,
-        FourCorners,
-        AllTop,
-        AllLeft,
-        AllRight,
-        AllLeftRight,
-        AllPerimeter,
-        Loose   
-    };
+    // - world space brush radii, ] doubles from the min and [ halves back
+    //   down to 0 (a single vertex)
+    static const float BRUSH_RADIUS_MIN;
+    static const float BRUSH_RADIUS_MAX;
 
 private:
-    // structs
-    struct cloth_vertex {
-        glm::vec3 pos_old;
-        glm::vec3 pos;
-        glm::vec3 norm;
-        glm::vec2 uv;
-        std::set<size_type> edge_indices;
-        int edge_up;
-        int edge_right;
-        int edge_down;
-        int edge_left;
-        int edge_diag_al;
-        int edge_diag_ar;
-        int edge_diag_bl;
-        int edge_diag_br;
-        int edge_2up;
-        int edge_2right;
-        int edge_2down;
-        int edge_2left;
-        size_type index;
-        float mass;
-        bool fixed;
-        bool active;
-    };
-    struct cloth_edge {
-        size_type vertex_a;
-        size_type vertex_b;
-        size_type index;
-        float flex_coeff;
-        float resting_length;
-        bool active;
-    };
-
     // private data members
-    size_type _n; // side vertex count
-    float _scale;
+    ClothSim _sim;
     render::mesh _mesh;
-    std::vector<cloth_vertex> _vertices;
-    std::vector<cloth_edge> _edges;
+    std::vector<glm::vec3> _normals;
     glm::mat4 _model_matrix;
-    glm::vec3 _a_gravity;
-    glm::vec3 _f_wind;
-    float _air_resist;
-    float _time_step;
-    float _time_simulated;
 
-    FixedPointArrangement _fpa;
     size_type _grabbed_vertex;
     float _grabbed_dist;
     bool _grabbing;
+    float _brush_radius;
 
     IntSnapshot _snapshot;
     sf::Vector2u _frame_size;
@@ -122,15 +71,13 @@ private:
     sf::Color _focused_color;
     bool _paused;
 
-    Cloth::size_type _num_phys_iterations;
-
 protected:
     // inherited from GuiComponent (sf::Drawable)
     virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
 
 public:
     // constructors
-    Cloth(sf::Vector2u _frame_size={1400,1000}, float scale=1.0f, size_type side_vertex_count=DEFAULT_SIDE_VERTEX_COUNT);
+    Cloth(sf::Vector2u _frame_size={1400,1000}, float scale=1.0f, size_type side_vertex_count=ClothSim::DEFAULT_SIDE_VERTEX_COUNT);
     Cloth(const Cloth& o);
     Cloth(Cloth&& o);
 
@@ -155,11 +102,17 @@ public:
     virtual bool hover(const sf::Vector2f& hover_pos);
 
     // accessors
+    ClothSim& get_sim();
+    const ClothSim& get_sim() const;
     float get_time_step() const;
     const glm::mat4& get_model_matrix() const;
     float get_scale() const;
     size_type get_n_vertices() const;
     FixedPointArrangement get_fixed_point_arrangement() const;
+    SolverStrategy get_solver_strategy() const;
+    ConstraintModel get_constraint_model() const;
+    size_type get_num_threads() const;
+    float get_brush_radius() const;
 
     // mutators
     void set_fixed_point(size_type v, bool fixed);
@@ -173,6 +126,18 @@ public:
     void set_image_texture(const sf::Texture& tex);
     void set_text_texture(const sf::Texture& tex);
     void set_phys_iterations(Cloth::size_type num_iters);
+    void set_solver_strategy(SolverStrategy strategy);
+    void set_constraint_model(ConstraintModel model);
+    void set_substeps(size_type num_substeps);
+    void set_num_threads(size_type num_threads);
+    void set_sleeping(bool sleep);
+    void set_self_collision(bool collide);
+    // - world space, 0 grabs and tears a single vertex
+    void set_brush_radius(float radius);
+    // - in simulation space, not drawn
+    size_type add_collider(const physics::collider& c);
+    size_type add_mesh_collider(const std::vector<glm::vec3>& vertices, const std::vector<std::uint32_t>& indices, float friction, bool continuous=true);
+    void clear_colliders();
 
     // gui appearance
     void setOutlineColor(const sf::Color& outline_color);
@@ -185,10 +150,6 @@ public:
     // texture accessors
     const sf::Texture& getRenderedTexture() const;
 
-    // graph accessors
-    size_type edge_connection(size_type e, size_type v) const;
-    size_type edge_connection(const cloth_edge& e, size_type v) const;
-
     // update functions
     void update_mouse_movement();
     void update_physics();
@@ -211,23 +172,11 @@ public:
 
 private:
     // private functions
-    // - initialization
-    void _initialize_cloth_vertices();
-    void _init_fixed_points();
-    void _add_edges_init_vertex(size_type v, int r, int c);
-    size_type _add_edge(size_type a, size_type b, float length, float flex_coeff);
-    // - constraint resolving
-    size_type _resolve_physics_constraints();
-    bool _resolve_plane_intersection(cloth_vertex& v);
-    // - mesh manipulation
-    bool _erase_edge(size_type e);
-    bool _erase_edge(cloth_edge& edge);
-    bool _erase_vertex(size_type v);
-    bool _erase_vertex(cloth_vertex& vert);
-    // bool _split_vertex(size_type v, bool horizontal);
-    // bool _split_vertex(cloth_vertex& v, bool horizontal);
-    // bool _split_vertex_horizontal(cloth_vertex& v);
-    // bool _split_vertex_vertical(cloth_vertex& v);
+    // - nearest active vertex under the mouse, and its world position
+    bool _pick_vertex(size_type& v, glm::vec3& world_pos);
+    // - active vertices within the brush of vertex v, appended to out
+    void _brush_vertices(size_type v, std::vector<size_type>& out);
+    void _reset_model_matrix();
 };
 
 #endif
\ No newline at end of file
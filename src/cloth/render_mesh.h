@@ -5,12 +5,10 @@
 
 #include "../../lib/glm/vec3.hpp"
 
+#include "../physics/cloth_surface.h"
+
 namespace render {
-    struct vertex {
-        glm::vec3 pos;
-        glm::vec3 norm;
-        glm::vec2 uv;
-    };
+    typedef physics::surface_vertex vertex;
     struct mesh {
         vertex* vertices;
         GLint size;
@@ -49,7 +49,10 @@ const unsigned TEXT_REND_TEXT_COLOR = 0x222222FF;
 const unsigned TEXT_REND_CHAR_SIZE = 72;
 
 // cloth initial values
-const Cloth::size_type INIT_CLOTH_VERTICES = Cloth::DEFAULT_SIDE_VERTEX_COUNT;
+const Cloth::size_type INIT_CLOTH_VERTICES = ClothSim::DEFAULT_SIDE_VERTEX_COUNT;
+const Cloth::size_type MAX_CLOTH_VERTICES = 512;
+// - larger cloths switch to the multigrid solver
+const Cloth::size_type MULTIGRID_CLOTH_VERTICES = 64;
 const float INIT_CLOTH_SCALE = 2.0f;
 const glm::vec3 INIT_LIGHT_DIR = {2.0f,2.0f,-10.0f};
 const glm::vec3 INIT_GRAVITY = {0,-9.8f,0};
@@ -276,16 +279,16 @@ int main()
     DropdownMenu fpa_select({}, text_font, TEXT_SIZE, "Select Cloth Configuration...");
     components.push_back(&fpa_select);
     Global::mouse_tracker.addClickableComponent(fpa_select);
-    fpa_select.addItem(sf::String("Curtain"), Cloth::Curtain);
-    fpa_select.addItem(sf::String("Flag (Left)"), Cloth::FlagLeft);
-    fpa_select.addItem(sf::String("Flat (Right)"), Cloth::FlatRight);
-    fpa_select.addItem(sf::String("Four Corners"), Cloth::FourCorners);
-    fpa_select.addItem(sf::String("All Top"), Cloth::AllTop);
-    fpa_select.addItem(sf::String("All Left"), Cloth::AllLeft);
-    fpa_select.addItem(sf::String("All Right"), Cloth::AllRight);
-    fpa_select.addItem(sf::String("All Left & Right"), Cloth::AllLeftRight);
-    fpa_select.addItem(sf::String("Full Perimeter"), Cloth::AllPerimeter);
-    fpa_select.addItem(sf::String("Loose"), Cloth::Loose);
+    fpa_select.addItem(sf::String("Curtain"), ClothSim::Curtain);
+    fpa_select.addItem(sf::String("Flag (Left)"), ClothSim::FlagLeft);
+    fpa_select.addItem(sf::String("Flat (Right)"), ClothSim::FlatRight);
+    fpa_select.addItem(sf::String("Four Corners"), ClothSim::FourCorners);
+    fpa_select.addItem(sf::String("All Top"), ClothSim::AllTop);
+    fpa_select.addItem(sf::String("All Left"), ClothSim::AllLeft);
+    fpa_select.addItem(sf::String("All Right"), ClothSim::AllRight);
+    fpa_select.addItem(sf::String("All Left & Right"), ClothSim::AllLeftRight);
+    fpa_select.addItem(sf::String("Full Perimeter"), ClothSim::AllPerimeter);
+    fpa_select.addItem(sf::String("Loose"), ClothSim::Loose);
     fpa_select.setPosition(cloth_text_color.getPosition()+sf::Vector2f{0, 100.0f});
     fpa_select.setBackgroundFillColor(sf::Color(0xDDDDDDFF));
     fpa_select.setBackgroundOutlineColor(sf::Color(0x57595DFF));
@@ -305,7 +308,7 @@ int main()
     Global::mouse_tracker.addClickableComponent(cloth_vertices);
     cloth_vertices.setPosition(fpa_select.getPosition()+sf::Vector2f{0,150});
     cloth_vertices.setMinIntValue(2);
-    cloth_vertices.setMaxIntValue(64);
+    cloth_vertices.setMaxIntValue(MAX_CLOTH_VERTICES);
     cloth_vertices.setIntValue(INIT_CLOTH_VERTICES);
     cloth_vertices.setLabel("Cloth Vertices: ");
 
@@ -326,7 +329,7 @@ int main()
     cloth_iters.setPosition(cloth_scale.getPosition()+sf::Vector2f{0,55});
     // cloth_iters.setNumberType(NumberInput::Int);
     cloth_iters.setMinIntValue(1);
-    cloth_iters.setIntValue(Cloth::PHYSICS_ITERATIONS);
+    cloth_iters.setIntValue(ClothSim::PHYSICS_ITERATIONS);
     cloth_iters.setLabel("Iterations: ");
 
     // setup gravity x
@@ -436,14 +439,14 @@ int main()
 Instructions: Click sim view to use keyboard controls\n\
 WASD:    Move camera\n\
 Arrows:  Look around\n\
-Space:   Float up\n\
-Shift:   Float down\n\
+Space:   Float up (Shift: down)\n\
+R:       Reset cam & sim\n\
 "),sf::String("\
 \n\
-L-Click: Grab vertex\n\
+L-Click: Grab vertices\n\
 R-Click: Tear vertices (hold)\n\
-Q:       Pin grabbed vertex\n\
-R:       Reset cam & sim\n\
+[ / ]:   Brush size\n\
+Q:       Pin grabbed vertices\n\
 "));
     htp.setTextFillColor(sf::Color(0x222222FF));
     htp.setFillColor(sf::Color(0x888888FF));
@@ -622,6 +625,7 @@ R:       Reset cam & sim\n\
         cloth.set_gravity({gravity_x.getFloatValue(), gravity_y.getFloatValue(), gravity_z.getFloatValue()});
         cloth.set_wind_force({wind_force_x.getFloatValue(), wind_force_y.getFloatValue(), wind_force_z.getFloatValue()});
         cloth.set_n_vertices(cloth_vertices.getIntValue());
+        cloth.set_solver_strategy(cloth_vertices.getIntValue() > MULTIGRID_CLOTH_VERTICES ? ClothSim::Multigrid : ClothSim::GaussSeidel);
         cloth.set_fixed_point_arrangement((Cloth::FixedPointArrangement)
             (fpa_select.hasSelection() ? fpa_select.getSelectedItemID() : 0));
         cloth.set_phys_iterations(cloth_iters.getIntValue());
@@ -0,0 +1,68 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: aligned_allocator.h
+ *  Cache-line aligned allocator for the solver's contiguous arrays
+ * **************************************************************************** */
+
+#ifndef ALIGNED_ALLOCATOR_H
+#define ALIGNED_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace physics {
+    // alignment of every solver array (one cache line, also covers AVX loads)
+    const std::size_t SOLVER_ALIGNMENT = 64;
+
+    template<class T, std::size_t Align=SOLVER_ALIGNMENT>
+    class aligned_allocator {
+    public:
+        // typedefs
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+
+        template<class U>
+        struct rebind { typedef aligned_allocator<U, Align> other; };
+
+        // constructors
+        aligned_allocator() { }
+        template<class U>
+        aligned_allocator(const aligned_allocator<U, Align>&) { }
+
+        // allocation
+        T* allocate(size_type n) {
+            void* p = nullptr;
+            if(posix_memalign(&p, Align, n*sizeof(T)) != 0)
+                throw std::bad_alloc();
+            return static_cast<T*>(p);
+        }
+        void deallocate(T* p, size_type) {
+            free(p);
+        }
+    };
+
+    template<class T, class U, std::size_t Align>
+    bool operator==(const aligned_allocator<T, Align>&, const aligned_allocator<U, Align>&) {
+        return true;
+    }
+    template<class T, class U, std::size_t Align>
+    bool operator!=(const aligned_allocator<T, Align>&, const aligned_allocator<U, Align>&) {
+        return false;
+    }
+
+    // contiguous, cache-line aligned array
+    template<class T>
+    using aligned_vector = std::vector<T, aligned_allocator<T> >;
+}
+
+#endif
@@ -0,0 +1,114 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: attachments.cpp
+ *  Definition file for the long-range attachment (tether) constraints
+ * **************************************************************************** */
+
+#include "attachments.h"
+
+#include "../../lib/glm/glm.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+/* ============================================================================ *
+ * Attachment Set
+ * ============================================================================ */
+void physics::attachment_set::clear() {
+    vertex.clear();
+    anchor.clear();
+    max_length.clear();
+}
+
+void physics::attachment_set::build(size_type num_particles, const std::vector<distance_constraint>& edges, const std::vector<size_type>& anchors, float slack) {
+    clear();
+    // adjacency in compressed rows
+    std::vector<size_type> row(num_particles+1, 0);
+    for(auto it=edges.begin(); it!=edges.end(); ++it) {
+        row[it->a+1]++;
+        row[it->b+1]++;
+    }
+    for(size_type i=0; i<num_particles; i++)
+        row[i+1] += row[i];
+    std::vector<size_type> fill(row.begin(), row.end()-1);
+    std::vector<std::pair<size_type, float>> adj(row[num_particles]);
+    for(auto it=edges.begin(); it!=edges.end(); ++it) {
+        adj[fill[it->a]++] = {it->b, it->rest_length};
+        adj[fill[it->b]++] = {it->a, it->rest_length};
+    }
+    // multi-source dijkstra, every particle remembers the anchor it came from
+    const float inf = std::numeric_limits<float>::infinity();
+    std::vector<float> dist(num_particles, inf);
+    std::vector<std::int32_t> source(num_particles, -1);
+    typedef std::pair<float, size_type> entry;
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry>> queue;
+    for(auto it=anchors.begin(); it!=anchors.end(); ++it) {
+        dist[*it] = 0;
+        source[*it] = *it;
+        queue.push({0.0f, *it});
+    }
+    while(!queue.empty()) {
+        entry top = queue.top();
+        queue.pop();
+        size_type v = top.second;
+        if(top.first > dist[v])
+            continue;
+        for(size_type k=row[v]; k<row[v+1]; k++) {
+            size_type u = adj[k].first;
+            float d = dist[v] + adj[k].second;
+            if(d < dist[u]) {
+                dist[u] = d;
+                source[u] = source[v];
+                queue.push({d, u});
+            }
+        }
+    }
+    // anchors and unreachable particles get no attachment
+    for(size_type i=0; i<num_particles; i++) {
+        if(dist[i] > 0 && dist[i] < inf) {
+            vertex.push_back(i);
+            anchor.push_back(source[i]);
+            max_length.push_back(dist[i]*(1.0f + slack));
+        }
+    }
+}
+
+
+
+/* ============================================================================ *
+ * Solving
+ * ============================================================================ */
+std::size_t physics::solve_attachments(particle_set& p, const attachment_set& a, std::size_t begin, std::size_t end) {
+    std::size_t count_resolved = 0;
+    for(std::size_t k=begin; k<end; k++) {
+        std::size_t v = a.vertex[k];
+        if(p.is_pinned(v))
+            continue;
+        glm::vec3 d = p.pos[v] - p.pos[a.anchor[k]];
+        float len_sq = glm::dot(d, d);
+        float max_len = a.max_length[k];
+        if(len_sq > max_len*max_len) {
+            // pull straight back onto the sphere around the anchor
+            p.pos[v] -= d*(1.0f - max_len/std::sqrt(len_sq));
+            count_resolved++;
+        }
+    }
+    return count_resolved;
+}
+
+std::size_t physics::solve_attachments(particle_set& p, const attachment_set& a, ThreadPool& pool) {
+    std::atomic<std::size_t> count_resolved(0);
+    pool.run([&](std::size_t thread, std::size_t num_threads) {
+        std::size_t b = a.size()*thread/num_threads;
+        std::size_t e = a.size()*(thread+1)/num_threads;
+        count_resolved.fetch_add(solve_attachments(p, a, b, e), std::memory_order_relaxed);
+    });
+    return count_resolved.load();
+}
@@ -0,0 +1,70 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: attachments.h
+ *  Header file for the long-range attachment (tether) constraints
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: A long-range attachment ties a free particle to its nearest anchor
+ *  (a pinned particle) by the geodesic rest distance between them, the
+ *  shortest path over the constraint graph at rest. It is unilateral: the
+ *  particle is only pulled back onto the sphere around the anchor when it
+ *  is farther away than that, so the cloth may still fold and bunch up.
+ *  Since the geodesic is never shorter than the straight line at rest, a
+ *  fully satisfied cloth never violates its attachments. Each attachment
+ *  moves only its own particle and anchors never move, so every attachment
+ *  can be solved independently.
+ * ---------------------------------------------------------------------------- */
+
+#ifndef ATTACHMENTS_H
+#define ATTACHMENTS_H
+
+#include "particles.h"
+#include "constraints.h"
+#include "aligned_allocator.h"
+#include "thread_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace physics {
+    struct attachment_set {
+        // typedefs
+        typedef std::size_t size_type;
+
+        // solver arrays (all indexed by attachment)
+        aligned_vector<std::int32_t> vertex;
+        aligned_vector<std::int32_t> anchor;
+        aligned_vector<float> max_length;
+
+        // container properties
+        size_type size() const;
+        bool empty() const;
+
+        // container manipulation
+        void clear();
+        // - attaches every particle reachable over the edges to its nearest
+        //   anchor (multi-source dijkstra over rest lengths), max_length is
+        //   the geodesic distance scaled by 1 + slack
+        void build(size_type num_particles, const std::vector<distance_constraint>& edges, const std::vector<size_type>& anchors, float slack);
+    };
+
+    // - projects every attachment, returns the number that were violated
+    std::size_t solve_attachments(particle_set& p, const attachment_set& a, std::size_t begin, std::size_t end);
+    // - splits the attachments evenly across the pool
+    std::size_t solve_attachments(particle_set& p, const attachment_set& a, ThreadPool& pool);
+
+    // inline accessors
+    inline attachment_set::size_type attachment_set::size() const {
+        return vertex.size();
+    }
+    inline bool attachment_set::empty() const {
+        return vertex.empty();
+    }
+}
+
+#endif
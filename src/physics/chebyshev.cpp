@@ -0,0 +1,47 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: chebyshev.cpp
+ *  Definition file for the Chebyshev semi-iterative acceleration of the sweeps
+ * **************************************************************************** */
+
+#include "chebyshev.h"
+
+/* ============================================================================ *
+ * Chebyshev Accelerator
+ * ============================================================================ */
+void physics::chebyshev_accelerator::begin(const particle_set& p) {
+    pos_prev.assign(p.pos.begin(), p.pos.end());
+    pos_cur.assign(p.pos.begin(), p.pos.end());
+    iteration = 0;
+    omega = 1.0f;
+}
+
+float physics::chebyshev_accelerator::accelerate(particle_set& p) {
+    iteration++;
+    if(iteration < warmup)
+        omega = 1.0f;
+    else if(iteration == warmup)
+        omega = 2.0f/(2.0f - rho*rho);
+    else
+        omega = 4.0f/(4.0f - rho*rho*omega);
+    for(size_type i=0; i<p.size(); i++) {
+        glm::vec3 q = p.pos[i];
+        // pinned particles never move, the plain sweep result is exact
+        if(omega != 1.0f && !p.is_pinned(i)) {
+            q = omega*(q - pos_prev[i]) + pos_prev[i];
+            p.pos[i] = q;
+        }
+        pos_prev[i] = pos_cur[i];
+        pos_cur[i] = q;
+    }
+    return omega;
+}
+
+void physics::chebyshev_accelerator::restart() {
+    // back to plain sweeps until the warm-up count is reached again
+    iteration = 0;
+    omega = 1.0f;
+}
@@ -0,0 +1,54 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: chebyshev.h
+ *  Header file for the Chebyshev semi-iterative acceleration of the sweeps
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: After the k-th sweep of a step produced q^, the accelerated iterate is
+ *      q_k = omega_k*(q^ - q_{k-2}) + q_{k-2}
+ *  with omega_k = 1 during the warm-up sweeps, then
+ *      omega = 2/(2 - rho^2), omega = 4/(4 - rho^2*omega), ...
+ *  where rho is an estimate of the spectral radius of one plain sweep (how
+ *  much of the error a sweep leaves behind). A higher rho extrapolates more
+ *  aggressively: too low only wastes the acceleration, too high oscillates.
+ *  The warm-up sweeps let the early, non-linear corrections (collisions,
+ *  fresh gravity) settle before extrapolating from them.
+ * ---------------------------------------------------------------------------- */
+
+#ifndef CHEBYSHEV_H
+#define CHEBYSHEV_H
+
+#include "../../lib/glm/vec3.hpp"
+
+#include "particles.h"
+#include "aligned_allocator.h"
+
+#include <cstddef>
+
+namespace physics {
+    struct chebyshev_accelerator {
+        // typedefs
+        typedef std::size_t size_type;
+
+        // iterates q_{k-2} and q_{k-1}, indexed by particle
+        aligned_vector<glm::vec3> pos_prev;
+        aligned_vector<glm::vec3> pos_cur;
+        float rho;
+        size_type warmup;
+        size_type iteration;
+        float omega;
+
+        // - starts a step from the current positions
+        void begin(const particle_set& p);
+        // - accelerates the sweep that just ran, returns the omega applied
+        float accelerate(particle_set& p);
+        // - falls back to plain sweeps for another warm-up
+        void restart();
+    };
+}
+
+#endif
@@ -0,0 +1,1391 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: cloth_sim.cpp
+ *  Definition file for ClothSim class
+ * **************************************************************************** */
+
+#include "cloth_sim.h"
+
+#include "constraint_kernel.h"
+#include "solvers.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+/* ============================================================================ *
+ * Static Constant Definitions
+ * ============================================================================ */
+const ClothSim::size_type 
+ClothSim::DEFAULT_SIDE_VERTEX_COUNT
+    = 32;
+const ClothSim::size_type 
+ClothSim::PHYSICS_ITERATIONS
+    = 16;
+const float 
+ClothSim::DEFAULT_TIME_STEP 
+    = 1.0f/60.0f;
+const float 
+ClothSim::NEIGHBOR_FLEX_COEFF   
+    = 0.01f;
+const float 
+ClothSim::BENDING_FLEX_COEFF   
+    = 0.05f;
+const float
+ClothSim::NEIGHBOR_COMPLIANCE
+    = 1e-7f;
+const float
+ClothSim::BENDING_COMPLIANCE
+    = 1e-5f;
+const float 
+ClothSim::NEIGHBOR_TEAR_THRESH
+    = 2.0f; // of the rest length
+const float 
+ClothSim::FLOOR_PLANE_Y   
+    //= -1.0*DEFAULT_SIDE_VERTEX_COUNT;
+    = -1.15f;
+const float 
+ClothSim::FLOOR_PLANE_FRICTION_COEFF   
+    = 0.1f;
+const unsigned
+ClothSim::EDGE_COLOR_COUNT
+    = 12; // 2 per edge direction, see _add_edges_init_vertex()
+const ClothSim::size_type
+ClothSim::TILE_SIDE_VERTEX_COUNT
+    = 32; // ~28KB of particles + ~150KB of constraints, sized for L2
+const ClothSim::size_type
+ClothSim::TILE_LOCAL_ITERATIONS
+    = 4;
+const float
+ClothSim::DEFAULT_ERROR_TOLERANCE
+    = 1e-3f; // of the rest length
+const float
+ClothSim::DEFAULT_RMS_ERROR_TOLERANCE
+    = 0.0f; // disabled
+const float
+ClothSim::DEFAULT_SPECTRAL_RADIUS
+    = 0.95f;
+const ClothSim::size_type
+ClothSim::CHEBYSHEV_WARMUP_ITERATIONS
+    = 4;
+const float
+ClothSim::CHEBYSHEV_DIVERGENCE_RATIO
+    = 4.0f; // of the previous sweep's squared error
+const float
+ClothSim::ATTACHMENT_SLACK
+    = 0.01f; // of the geodesic rest distance
+const ClothSim::size_type
+ClothSim::MULTIGRID_MIN_SIDE_VERTEX_COUNT
+    = 4;
+const ClothSim::size_type
+ClothSim::MULTIGRID_LEVEL_ITERATIONS
+    = 4;
+const ClothSim::size_type
+ClothSim::IMPLICIT_MAX_CG_ITERATIONS
+    = 200;
+const float
+ClothSim::IMPLICIT_CG_TOLERANCE
+    = 1e-3f; // of the rhs norm
+const unsigned
+ClothSim::MAX_VERTEX_EDGES;
+const float
+ClothSim::COMPACTION_RATIO
+    = 0.75f; // of the edges in the constraint slots
+const float
+ClothSim::SLEEP_SPEED
+    = 0.02f; // cloth scales per second
+const ClothSim::size_type
+ClothSim::SLEEP_STEPS
+    = 30;
+const float
+ClothSim::SELF_COLLISION_THICKNESS
+    = 0.75f; // of the rest spacing, below sqrt(5) (see self_collision.h)
+const ClothSim::size_type
+ClothSim::SELF_COLLISION_ITERATIONS
+    = 2;
+const float
+ClothSim::COLLIDER_MARGIN
+    = 0.25f; // of the rest spacing
+const float
+ClothSim::GRAB_COMPLIANCE
+    = 1e-7f; // as stiff as a neighbor edge
+const float
+ClothSim::JACOBI_RELAXATION
+    = 1.5f; // over-relaxes the averaged corrections, stable below 2
+
+
+
+/* ============================================================================ *
+ * Constructors
+ * ============================================================================ */
+ClothSim::ClothSim(float scale, size_type side_vertex_count)
+    : _n(side_vertex_count)
+    , _scale(scale)
+    , _particles()
+    , _constraints()
+    , _constraints_offset()
+    , _multipliers()
+    , _chebyshev()
+    , _attachments()
+    , _multigrid()
+    , _projective()
+    , _implicit()
+    , _colliders()
+    , _mesh_colliders()
+    , _picking()
+    , _grab()
+    , _erased_mask()
+    , _vertices()
+    , _edges()
+    , _a_gravity({0,-9.8,0})
+    , _f_wind({0,0,0})
+    , _air_resist(100.0f)
+    , _time_step(DEFAULT_TIME_STEP)
+    , _time_simulated(0)
+    , _fpa(Curtain)
+    , _num_phys_iterations(PHYSICS_ITERATIONS)
+    , _num_substeps(1)
+    , _adaptive_iterations(false)
+    , _error_tolerance(DEFAULT_ERROR_TOLERANCE)
+    , _rms_error_tolerance(DEFAULT_RMS_ERROR_TOLERANCE)
+    , _chebyshev_acceleration(false)
+    , _long_range_attachments(false)
+    , _tearing(false)
+    , _sleeping(false)
+    , _self_collision(false)
+    , _islands_dirty(true)
+    , _sleep_dirty(false)
+    , _self_collision_dirty(true)
+    , _attachments_dirty(true)
+    , _multigrid_dirty(true)
+    , _implicit_dirty(true)
+    , _picking_dirty(true)
+    , _system_version(0)
+    , _system_version_counter(0)
+    , _topology_version(0)
+    , _projective_key()
+    , _num_active_edges(0)
+    , _num_slotted_edges(0)
+    , _num_swept_edges(0)
+    , _step_stats()
+    , _solver_strategy(GaussSeidel)
+    , _constraint_model(FlexBand)
+    , _integrator(Verlet)
+    , _thread_pool(1)
+{
+    _chebyshev.rho = DEFAULT_SPECTRAL_RADIUS;
+    _chebyshev.warmup = CHEBYSHEV_WARMUP_ITERATIONS;
+    restart();
+}
+
+
+
+/* ============================================================================ *
+ * Accessors
+ * ============================================================================ */
+float ClothSim::get_time_step() const {
+    return _time_step;
+}
+double ClothSim::get_time_simulated() const {
+    return _time_simulated;
+}
+float ClothSim::get_scale() const {
+    return _scale;
+}
+ClothSim::size_type ClothSim::get_n_vertices() const {
+    return _n;
+}
+ClothSim::FixedPointArrangement ClothSim::get_fixed_point_arrangement() const {
+    return _fpa;
+}
+ClothSim::size_type ClothSim::get_phys_iterations() const {
+    return _num_phys_iterations;
+}
+ClothSim::size_type ClothSim::get_substeps() const {
+    return _num_substeps;
+}
+bool ClothSim::get_adaptive_iterations() const {
+    return _adaptive_iterations;
+}
+float ClothSim::get_error_tolerance() const {
+    return _error_tolerance;
+}
+float ClothSim::get_rms_error_tolerance() const {
+    return _rms_error_tolerance;
+}
+bool ClothSim::get_chebyshev_acceleration() const {
+    return _chebyshev_acceleration;
+}
+float ClothSim::get_spectral_radius() const {
+    return _chebyshev.rho;
+}
+ClothSim::size_type ClothSim::get_chebyshev_warmup() const {
+    return _chebyshev.warmup;
+}
+bool ClothSim::get_long_range_attachments() const {
+    return _long_range_attachments;
+}
+bool ClothSim::get_tearing() const {
+    return _tearing;
+}
+bool ClothSim::get_sleeping() const {
+    return _sleeping;
+}
+bool ClothSim::get_self_collision() const {
+    return _self_collision;
+}
+ClothSim::SolverStrategy ClothSim::get_solver_strategy() const {
+    return _solver_strategy;
+}
+ClothSim::ConstraintModel ClothSim::get_constraint_model() const {
+    return _constraint_model;
+}
+ClothSim::Integrator ClothSim::get_integrator() const {
+    return _integrator;
+}
+ClothSim::size_type ClothSim::get_num_threads() const {
+    return _thread_pool.size();
+}
+
+
+
+/* ============================================================================ *
+ * State Accessors
+ * ============================================================================ */
+const physics::particle_set& ClothSim::get_particles() const {
+    return _particles;
+}
+const std::vector<ClothSim::cloth_vertex>& ClothSim::get_vertices() const {
+    return _vertices;
+}
+const std::vector<ClothSim::cloth_edge>& ClothSim::get_edges() const {
+    return _edges;
+}
+ClothSim::size_type ClothSim::get_num_active_edges() const {
+    return _num_active_edges;
+}
+const std::vector<ClothSim::size_type>& ClothSim::get_active_vertices() const {
+    return _active_vertices;
+}
+const physics::collider_set& ClothSim::get_colliders() const {
+    return _colliders;
+}
+const std::vector<physics::mesh_collider>& ClothSim::get_mesh_colliders() const {
+    return _mesh_colliders;
+}
+const physics::grab_set& ClothSim::get_grab() const {
+    return _grab;
+}
+const physics::island_set& ClothSim::get_islands() const {
+    return _islands;
+}
+ClothSim::size_type ClothSim::get_topology_version() const {
+    return _topology_version;
+}
+const ClothSim::step_stats& ClothSim::get_step_stats() const {
+    return _step_stats;
+}
+
+
+
+/* ============================================================================ *
+ * Mutators
+ * ============================================================================ */
+void ClothSim::set_fixed_point(size_type v, bool fixed) {
+    // erased vertices stay pinned so the integrator keeps skipping them
+    if(_vertices[v].active && _particles.is_pinned(v) != fixed) {
+        _particles.set_pinned(v, fixed);
+        _wake_vertex(v);
+        _attachments_dirty = true;
+        _system_version = ++_system_version_counter;
+    }
+}
+void ClothSim::set_vertex_position(size_type v, const glm::vec3& pos) {
+    _wake_vertex(v);
+    _particles.pos_old[v] = _particles.pos[v];
+    _particles.pos[v] = pos;
+    _picking_dirty = true;
+}
+void ClothSim::set_gravity(const glm::vec3& gravity) {
+    if(_a_gravity != gravity && _islands.wake_all())
+        _sleep_dirty = true;
+    _a_gravity = gravity;
+}
+void ClothSim::set_wind_force(const glm::vec3& wind) {
+    if(_f_wind != wind && _islands.wake_all())
+        _sleep_dirty = true;
+    _f_wind = wind;
+}
+void ClothSim::set_time_step(float time_step) {
+    _time_step = time_step;
+}
+void ClothSim::set_scale(float scale) {
+    if(_scale != scale) {
+        _scale = scale;
+        restart();
+    }
+}
+void ClothSim::set_n_vertices(size_type n) {
+    if(_n != n) {
+        _n = n;
+        restart();
+    }
+}
+void ClothSim::set_fixed_point_arrangement(FixedPointArrangement fpa) {
+    if(_fpa != fpa) {
+        _fpa = fpa;
+        restart();
+    }
+}
+void ClothSim::set_phys_iterations(size_type num_iters) {
+    _num_phys_iterations = num_iters;
+}
+void ClothSim::set_substeps(size_type num_substeps) {
+    if(num_substeps < 1)
+        num_substeps = 1;
+    // verlet velocities are implied by pos - pos_old over one substep,
+    // rescale them to the new substep length
+    float ratio = (float)_num_substeps/num_substeps;
+    for(size_type i=0; i<_particles.size(); i++)
+        _particles.pos_old[i] = _particles.pos[i] - (_particles.pos[i] - _particles.pos_old[i])*ratio;
+    _num_substeps = num_substeps;
+}
+void ClothSim::set_adaptive_iterations(bool adaptive) {
+    _adaptive_iterations = adaptive;
+}
+void ClothSim::set_error_tolerance(float max_error, float rms_error) {
+    _error_tolerance = max_error;
+    _rms_error_tolerance = rms_error;
+}
+void ClothSim::set_solver_strategy(SolverStrategy strategy) {
+    if(_solver_strategy != strategy) {
+        _solver_strategy = strategy;
+        // constraint layout depends on the strategy
+        _init_constraints();
+    }
+}
+void ClothSim::set_chebyshev_acceleration(bool accelerate) {
+    _chebyshev_acceleration = accelerate;
+}
+void ClothSim::set_spectral_radius(float rho, size_type warmup) {
+    // omega stays finite below 1
+    _chebyshev.rho = std::max(0.0f, std::min(rho, 0.999f));
+    _chebyshev.warmup = std::max<size_type>(warmup, 1);
+}
+void ClothSim::set_long_range_attachments(bool attach) {
+    _long_range_attachments = attach;
+}
+void ClothSim::set_sleeping(bool sleep) {
+    if(_sleeping != sleep) {
+        _sleeping = sleep;
+        if(_islands.wake_all())
+            _sleep_dirty = true;
+        _islands.clear();
+        _islands_dirty = true;
+    }
+}
+void ClothSim::set_self_collision(bool collide) {
+    if(_self_collision != collide) {
+        _self_collision = collide;
+        _self_collisions.clear();
+        _self_collision_dirty = true;
+    }
+}
+void ClothSim::set_tearing(bool tear) {
+    if(_tearing != tear) {
+        _tearing = tear;
+        // tear lengths are part of the constraint slots
+        _init_constraints();
+    }
+}
+void ClothSim::set_constraint_model(ConstraintModel model) {
+    _constraint_model = model;
+}
+void ClothSim::set_integrator(Integrator integrator) {
+    // the other integrators step every particle
+    if(_integrator != integrator && _islands.wake_all())
+        _sleep_dirty = true;
+    _integrator = integrator;
+}
+void ClothSim::set_num_threads(size_type num_threads) {
+    _thread_pool.resize(num_threads);
+}
+ClothSim::size_type ClothSim::add_collider(const physics::collider& c) {
+    // a new shape may overlap resting islands
+    if(_islands.wake_all())
+        _sleep_dirty = true;
+    return _colliders.add(c);
+}
+ClothSim::size_type ClothSim::add_mesh_collider(const std::vector<glm::vec3>& vertices, const std::vector<std::uint32_t>& indices, float friction, bool continuous) {
+    if(_islands.wake_all())
+        _sleep_dirty = true;
+    _mesh_colliders.push_back(physics::mesh_collider());
+    _mesh_colliders.back().build(vertices, indices, friction, continuous);
+    return _mesh_colliders.size() - 1;
+}
+void ClothSim::clear_colliders() {
+    if(_islands.wake_all())
+        _sleep_dirty = true;
+    _colliders.clear();
+    _mesh_colliders.clear();
+}
+
+
+
+/* ============================================================================ *
+ * Graph Accessors
+ * ============================================================================ */
+ClothSim::size_type ClothSim::edge_connection(size_type e, size_type v) const {
+    const cloth_edge& edge = _edges[e];
+    return v ^ edge.vertex_a ^ edge.vertex_b;
+}
+ClothSim::size_type ClothSim::edge_connection(const cloth_edge& e, size_type v) const {
+    return v ^ e.vertex_a ^ e.vertex_b;
+}
+
+
+
+/* ============================================================================ *
+ * Vertex Edge List
+ * ============================================================================ */
+bool ClothSim::vertex_edge_list::empty() const {
+    return count == 0;
+}
+const int* ClothSim::vertex_edge_list::begin() const {
+    return index;
+}
+const int* ClothSim::vertex_edge_list::end() const {
+    return index + count;
+}
+void ClothSim::vertex_edge_list::clear() {
+    count = 0;
+}
+void ClothSim::vertex_edge_list::insert(int e) {
+    // edges are added in ascending order, so this is an append in practice
+    int* pos = std::lower_bound(index, index + count, e);
+    if(pos != index + count && *pos == e)
+        return;
+    if(count == MAX_VERTEX_EDGES)
+        throw std::length_error("ClothSim::vertex_edge_list::insert() : vertex has too many edges.");
+    std::copy_backward(pos, index + count, index + count + 1);
+    *pos = e;
+    count++;
+}
+void ClothSim::vertex_edge_list::erase(int e) {
+    int* pos = std::lower_bound(index, index + count, e);
+    if(pos == index + count || *pos != e)
+        return;
+    std::copy(pos + 1, index + count, pos);
+    count--;
+}
+
+
+
+/* ============================================================================ *
+ * Update Functions
+ * ============================================================================ */
+void ClothSim::update_physics() {
+    _step_stats = step_stats();
+    _commit_erasures();
+    if(_sleeping && _islands_dirty)
+        _init_islands();
+    // wake whatever the grab is about to drag, before the constraints are
+    // built for what is awake
+    if(!_grab.empty() && _grab.target_at(_time_simulated) != _grab.target_at(_time_simulated + _time_step)) {
+        for(size_type k=0; k<_grab.size(); k++)
+            _wake_vertex(_grab.vertex[k]);
+    }
+    if(_sleep_dirty)
+        _init_constraints();
+    if(_long_range_attachments && _attachments_dirty)
+        _init_attachments();
+    if(_solver_strategy == Multigrid && _multigrid_dirty)
+        _init_multigrid();
+    float h = _time_step/_num_substeps;
+    for(size_type s=0; s<_num_substeps; s++) {
+        // the grab aims at where the target is at the end of the substep
+        if(!_grab.empty())
+            _grab.begin_substep(_time_simulated + (double)(s + 1)*h, h, GRAB_COMPLIANCE);
+        if(_integrator == ImplicitEuler)
+            _update_implicit_substep(h);
+        // falls back to verlet if the system cannot be factored
+        else if(_integrator != ProjectiveDynamics || !_update_projective_substep(h))
+            _update_substep(h);
+    }
+    // edges torn by the sweeps of this step
+    _commit_erasures();
+    if(_sleeping && _integrator == Verlet)
+        _update_sleep();
+    _time_simulated += _time_step;
+    _grab.discard_before(_time_simulated);
+    _picking_dirty = true;
+}
+
+void ClothSim::restart() {
+    _num_active_edges = 0;
+    _particles.clear();
+    _constraints.clear();
+    _constraints_offset.clear();
+    _attachments.clear();
+    _attachments_dirty = true;
+    _multigrid.clear();
+    _multigrid_dirty = true;
+    _implicit.clear();
+    _implicit_dirty = true;
+    // the cached projective system stays valid for the same arrangement
+    _system_version = 0;
+    _topology_version++;
+    _pending_edges.clear();
+    _pending_vertices.clear();
+    _islands.clear();
+    _islands_dirty = true;
+    _sleep_dirty = false;
+    _self_collisions.clear();
+    _self_collision_dirty = true;
+    _vertices.clear();
+    _edges.clear();
+    _initialize_cloth_vertices();
+    _erased_mask.assign(_particles.pinned.size(), 0);
+    _picking_dirty = true;
+    // the pins were reset along with everything else
+    _grab.clear();
+}
+
+
+
+/* ============================================================================ *
+ * Mesh Manipulation
+ * ============================================================================ */
+bool ClothSim::erase_vertex(size_type v) {
+    if(v >= _vertices.size() || !_vertices[v].active)
+        return false;
+    _pending_vertices.push_back(v);
+    return true;
+}
+
+void ClothSim::commit_erasures() {
+    _commit_erasures();
+}
+
+
+
+/* ============================================================================ *
+ * Picking
+ * ============================================================================ */
+bool ClothSim::pick_vertex(const glm::vec3& origin, const glm::vec3& dir, float radius, size_type& v, float& t) {
+    _refit_picking();
+    return _picking.pick(_particles, _erased_mask, origin, dir, radius, v, t);
+}
+
+ClothSim::size_type ClothSim::vertices_within(const glm::vec3& center, float radius, std::vector<size_type>& out) {
+    _refit_picking();
+    return _picking.query_sphere(_particles, _erased_mask, center, radius, out);
+}
+
+
+
+/* ============================================================================ *
+ * Grabbing
+ * ============================================================================ */
+void ClothSim::begin_grab(const std::vector<size_type>& vertices, const glm::vec3& target) {
+    end_grab();
+    for(auto it=vertices.begin(); it!=vertices.end(); ++it) {
+        if(*it >= _vertices.size() || !_vertices[*it].active)
+            continue;
+        _grab.vertex.push_back(*it);
+        _grab.offset.push_back(_particles.pos[*it] - target);
+        // a grabbed pin comes loose, the grab holds it instead
+        set_fixed_point(*it, false);
+        _wake_vertex(*it);
+    }
+    _grab.lambda.assign(_grab.size(), glm::vec3(0.0f));
+    if(!_grab.empty())
+        _grab.add_sample(_time_simulated, target);
+}
+
+void ClothSim::set_grab_target(double time, const glm::vec3& target) {
+    if(!_grab.empty())
+        _grab.add_sample(time, target);
+}
+
+void ClothSim::place_grab(const glm::vec3& target) {
+    if(_grab.empty())
+        return;
+    for(size_type k=0; k<_grab.size(); k++) {
+        if(_vertices[_grab.vertex[k]].active)
+            set_vertex_position(_grab.vertex[k], target + _grab.offset[k]);
+    }
+    // later steps start from here
+    _grab.sample_time.clear();
+    _grab.sample_target.clear();
+    _grab.add_sample(_time_simulated, target);
+}
+
+void ClothSim::end_grab(bool pin) {
+    if(pin) {
+        for(size_type k=0; k<_grab.size(); k++)
+            set_fixed_point(_grab.vertex[k], true);
+    }
+    _grab.clear();
+}
+
+bool ClothSim::is_grabbing() const {
+    return !_grab.empty();
+}
+
+
+
+/* ============================================================================ *
+ * Private Functions - Initialization
+ * ============================================================================ */
+void ClothSim::_initialize_cloth_vertices() {
+    cloth_vertex v;
+    _particles.reserve(_n*_n);
+    _vertices.reserve(_n*_n);
+    for(int r=0; r<_n; r++) {
+        for(int c=0; c<_n; c++) {
+            // setup solver state
+            size_type index = _particles.push_back(
+                {_scale*c/_n, _scale*(-r)/_n, 0.001f*_scale*r/_n}, 1.0f/_scale);
+            // setup basic vertex data
+            v.edge_indices.clear();
+            v.edge_up = -1;
+            v.edge_right = -1;
+            v.edge_down = -1;
+            v.edge_left = -1;
+            v.edge_diag_al = -1;
+            v.edge_diag_ar = -1;
+            v.edge_diag_bl = -1;
+            v.edge_diag_br = -1;
+            v.edge_2up = -1;
+            v.edge_2right = -1;
+            v.edge_2down = -1;
+            v.edge_2left = -1;
+            v.index = index;
+            v.mass = _scale;
+            v.active = true;
+            // push back vertex
+            _vertices.push_back(std::move(v));
+            _add_edges_init_vertex(v.index, r, c);
+            // // add neighbor edges (only for vertices behind this one)
+            // _add_edge_relative(index, r, c, -1,  0, NEIGHBOR_SPRING_LENGTH_FLEX_COEFF);    // add above
+            // _add_edge_relative(index, r, c,  0, -1, NEIGHBOR_SPRING_LENGTH_FLEX_COEFF);    // add left
+            // _add_edge_relative(index, r, c, -1, -1, NEIGHBOR_SPRING_LENGTH_FLEX_COEFF);    // add above-left
+            // _add_edge_relative(index, r, c, -1,  1, NEIGHBOR_SPRING_LENGTH_FLEX_COEFF);    // add above-right
+            // // add bending edges (only for vertices behind this one)
+            // _add_edge_relative(index, r, c, -2,  0, BENDING_SPRING_LENGTH_FLEX_COEFF);    // add above
+            // _add_edge_relative(index, r, c,  0, -2, BENDING_SPRING_LENGTH_FLEX_COEFF);    // add left
+        }
+    }
+    // add default fixed points
+    _init_fixed_points();
+    // pack edges into solver batches
+    _init_constraints();
+    _init_active_vertices();
+}
+
+void ClothSim::_init_fixed_points() {
+    switch(_fpa) {
+        case Curtain:
+            _particles.set_pinned(0, true);
+            _particles.set_pinned(_n-1, true);
+            if(_n >= 16) {
+                _particles.set_pinned(_n+1, true);
+                _particles.set_pinned(2*_n-2, true);
+            }
+            break;
+        case FlagLeft:
+            _particles.set_pinned(0, true);
+            _particles.set_pinned((_n-1)*_n, true);
+            break;
+        case FlatRight:
+            _particles.set_pinned(_n-1, true);
+            _particles.set_pinned(_n*_n-1, true);
+            break;
+        case FourCorners:
+            _particles.set_pinned(0, true);
+            _particles.set_pinned(_n-1, true);
+            _particles.set_pinned((_n-1)*_n, true);
+            _particles.set_pinned(_n*_n-1, true);
+            break;
+        case AllTop:
+            for(size_type c=0; c<_n; c++)
+                _particles.set_pinned(c, true);
+            break;
+        case AllLeft:
+            for(size_type r=0; r<_n; r++)
+                _particles.set_pinned(r*_n, true);
+            break;
+        case AllRight:
+            for(size_type r=0; r<_n; r++)
+                _particles.set_pinned(r*_n+(_n-1), true);
+            break;
+        case AllLeftRight:
+            for(size_type r=0; r<_n; r++) {
+                _particles.set_pinned(r*_n, true);
+                _particles.set_pinned(r*_n+(_n-1), true);
+            }
+            break;
+        case AllPerimeter:
+            for(size_type c=0; c<_n; c++) {
+                _particles.set_pinned(c, true);
+                _particles.set_pinned((_n-1)*_n+c, true);
+            }
+            for(size_type r=1; r<_n-1; r++) {
+                _particles.set_pinned(r*_n, true);
+                _particles.set_pinned(r*_n+(_n-1), true);
+            }
+            break;
+        // case Loose:
+        default: break;
+    }
+}
+
+void ClothSim::_add_edges_init_vertex(size_type v, int r, int c) {
+    cloth_vertex& vert = _vertices[v];
+
+    float neighbor_length = _scale/_n;
+    float diag_length = sqrt(2*neighbor_length*neighbor_length);
+    float bending_length = 2*neighbor_length;
+
+    // edge colors
+    // - each direction gets 2 colors, alternating with the row (or column)
+    //   parity so that no two edges of the same color share a vertex
+    // - bending edges span 2 rows/columns, so they alternate every 2
+
+    // add above
+    int r2 = r-1;
+    int c2 = c;
+    if(r2 >= 0) {
+        int v2 = r2*_n + c2;
+        float length = neighbor_length;
+        size_type e = _add_edge(v, v2, length, NEIGHBOR_FLEX_COEFF, NEIGHBOR_COMPLIANCE, 0 + (r&1));
+        vert.edge_up = e;
+        _vertices[v2].edge_down = e;
+    }
+    // add left
+    r2 = r;
+    c2 = c-1;
+    if(c2 >= 0) {
+        int v2 = r2*_n + c2;
+        float length = neighbor_length;
+        size_type e = _add_edge(v, v2, length, NEIGHBOR_FLEX_COEFF, NEIGHBOR_COMPLIANCE, 2 + (c&1));
+        vert.edge_left = e;
+        _vertices[v2].edge_right = e;
+    }
+    // add above-left
+    r2 = r-1;
+    c2 = c-1;
+    if(r2 >= 0 && c2 >= 0) {
+        int v2 = r2*_n + c2;
+        float length = diag_length; // sqrt(2)
+        size_type e = _add_edge(v, v2, length, NEIGHBOR_FLEX_COEFF, NEIGHBOR_COMPLIANCE, 4 + (r&1));
+        vert.edge_diag_al = e;
+        _vertices[v2].edge_diag_br = e;
+    }
+    // add above-right
+    r2 = r-1;
+    c2 = c+1;
+    if(r2 >= 0 && c2 < _n) {
+        int v2 = r2*_n + c2;
+        float length = diag_length; // sqrt(2)
+        size_type e = _add_edge(v, v2, length, NEIGHBOR_FLEX_COEFF, NEIGHBOR_COMPLIANCE, 6 + (r&1));
+        vert.edge_diag_ar = e;
+        _vertices[v2].edge_diag_bl = e;
+    }
+    // add bending above
+    r2 = r-2;
+    c2 = c;
+    if(r2 >= 0) {
+        int v2 = r2*_n + c2;
+        float length = bending_length;
+        size_type e = _add_edge(v, v2, length, BENDING_FLEX_COEFF, BENDING_COMPLIANCE, 8 + ((r>>1)&1));
+        vert.edge_2up = e;
+        _vertices[v2].edge_2down = e;
+    }
+    // add bending left
+    r2 = r;
+    c2 = c-2;
+    if(c2 >= 0) {
+        int v2 = r2*_n + c2;
+        float length = bending_length;
+        size_type e = _add_edge(v, v2, length, BENDING_FLEX_COEFF, BENDING_COMPLIANCE, 10 + ((c>>1)&1));
+        vert.edge_2left = e;
+        _vertices[v2].edge_2right = e;
+    }
+}
+
+ClothSim::size_type ClothSim::_add_edge(size_type a, size_type b, float length, float flex_coeff, float compliance, unsigned color) {
+    if(a > b)
+        std::swap(a, b);
+    cloth_edge e;
+    size_type index = _edges.size();
+    e.vertex_a = a;
+    e.vertex_b = b;
+    e.index = index;
+    e.flex_coeff = flex_coeff;
+    e.compliance = compliance;
+    e.resting_length = length;
+    e.color = color;
+    e.active = true;
+    _edges.push_back(std::move(e));
+    _num_active_edges++;
+    _vertices[a].edge_indices.insert(index);
+    _vertices[b].edge_indices.insert(index);
+    return index;
+}
+
+void ClothSim::_init_constraints() {
+    std::vector<physics::distance_constraint> constraints;
+    constraints.reserve(_edges.size());
+    size_type num_swept = 0;
+    for(auto it=_edges.begin(); it!=_edges.end(); ++it) {
+        // only neighbor edges tear, the others follow them (see _detach_edge)
+        float tear_ratio = _tearing && it->flex_coeff == NEIGHBOR_FLEX_COEFF ? NEIGHBOR_TEAR_THRESH : 0.0f;
+        bool disabled = !it->active || _islands.is_asleep(it->vertex_a);
+        constraints.push_back({it->vertex_a, it->vertex_b, it->resting_length, it->flex_coeff, it->compliance, it->color, tear_ratio, disabled});
+        if(!disabled)
+            num_swept++;
+    }
+    // constraint ids match edge indices, erased edges and the edges of
+    // asleep islands get no slot
+    _num_slotted_edges = num_swept;
+    _num_swept_edges = num_swept;
+    _sleep_dirty = false;
+    // the coarse levels leave out asleep islands the same way
+    _multigrid_dirty = true;
+    _constraints_offset.clear();
+    _jacobi.clear();
+    switch(_solver_strategy) {
+        case Colored:
+            _constraints.build_colored(constraints, EDGE_COLOR_COUNT);
+            break;
+        case Tiled:
+            _constraints.build_tiled(constraints, _n, TILE_SIDE_VERTEX_COUNT, 0);
+            _constraints_offset.build_tiled(constraints, _n, TILE_SIDE_VERTEX_COUNT, TILE_SIDE_VERTEX_COUNT/2);
+            break;
+        case Jacobi:
+            // any slot order works, the GaussSeidel one keeps neighbors close
+            _constraints.build(constraints, _particles.size());
+            _jacobi.build(_constraints, _particles.size());
+            break;
+        // case Multigrid:
+        //  fine level sweeps as GaussSeidel, coarse levels are built lazily
+        // case GaussSeidel:
+        default:
+            _constraints.build(constraints, _particles.size());
+    }
+}
+
+void ClothSim::_init_active_vertices() {
+    _active_vertices.clear();
+    for(auto it=_vertices.begin(); it!=_vertices.end(); ++it) {
+        if(it->active)
+            _active_vertices.push_back(it->index);
+    }
+}
+
+void ClothSim::_init_islands() {
+    std::vector<size_type> members;
+    members.reserve(_active_vertices.size());
+    for(auto it=_active_vertices.begin(); it!=_active_vertices.end(); ++it) {
+        if(_vertices[*it].active)
+            members.push_back(*it);
+    }
+    std::vector<physics::distance_constraint> edges;
+    _active_distance_constraints(edges);
+    _islands.build(_particles.size(), members, edges);
+    _islands_dirty = false;
+}
+
+void ClothSim::_init_self_collision() {
+    std::vector<size_type> members;
+    members.reserve(_active_vertices.size());
+    for(auto it=_active_vertices.begin(); it!=_active_vertices.end(); ++it) {
+        if(_vertices[*it].active)
+            members.push_back(*it);
+    }
+    _self_collisions.build(members);
+    _self_collision_dirty = false;
+}
+
+void ClothSim::_init_attachments() {
+    // anchors are the pinned vertices that are still part of the cloth
+    std::vector<size_type> anchors;
+    for(auto it=_vertices.begin(); it!=_vertices.end(); ++it) {
+        if(it->active && _particles.is_pinned(it->index))
+            anchors.push_back(it->index);
+    }
+    std::vector<physics::distance_constraint> edges;
+    _active_distance_constraints(edges);
+    _attachments.build(_particles.size(), edges, anchors, ATTACHMENT_SLACK);
+    _attachments_dirty = false;
+}
+
+void ClothSim::_init_multigrid() {
+    std::vector<physics::distance_constraint> edges;
+    _active_distance_constraints(edges);
+    _multigrid.build(_n, edges, _islands.asleep_mask, MULTIGRID_MIN_SIDE_VERTEX_COUNT, NEIGHBOR_FLEX_COEFF);
+    _multigrid_dirty = false;
+}
+
+
+
+
+/* ============================================================================ *
+ * Private Functions - Constraint Resolving
+ * ============================================================================ */
+void ClothSim::_update_substep(float h) {
+    typedef physics::particle_set::mask_word mask_word;
+    const size_type word_bits = physics::particle_set::MASK_WORD_BITS;
+    float ts_sqr = h*h;
+    // walk the pinned bitmask a word at a time, skipping fully pinned words
+    for(size_type w=0; w<_particles.pinned.size(); w++) {
+        mask_word asleep = w < _islands.asleep_mask.size() ? _islands.asleep_mask[w] : 0;
+        mask_word free_bits = ~(_particles.pinned[w] | asleep);
+        while(free_bits) {
+            size_type i = w*word_bits + __builtin_ctz(free_bits);
+            free_bits &= free_bits - 1;
+            glm::vec3& pos = _particles.pos[i];
+            glm::vec3& pos_old = _particles.pos_old[i];
+            // determine vertice's new position
+            // - uses verlet integration
+            // - equation source: https://graphics.stanford.edu/~mdfisher/cloth.html
+            glm::vec3 pos_new = pos;
+            pos_new *= 2.0;
+            pos_new -= pos_old;
+            // gravity + wind (a = (m*g + f_wind)/m)
+            glm::vec3 a = _a_gravity;
+            a += _f_wind*_particles.inv_mass[i];
+            // air resist
+            // a += -_air_resist*vel*vel;
+            a *= ts_sqr;
+            pos_new += a;
+            // apply new position
+            pos_old = pos;
+            pos = pos_new;
+            // resolve plane collision
+            _resolve_plane_intersection(pos, pos_old);
+        }
+    }
+    // tethers first, so the sweeps start close to the pins' reach
+    if(_long_range_attachments)
+        physics::solve_attachments(_particles, _attachments, _thread_pool);
+    // xpbd multipliers accumulate over the sweeps of one (sub)step
+    if(_constraint_model == Xpbd)
+        _multipliers.reset(_edges.size(), h);
+    _solve_constraints();
+    if(_self_collision)
+        _resolve_self_collisions();
+    _resolve_colliders();
+    // resolve any plane collisions that may have occurred during physics contraints 
+    _resolve_plane_intersections();
+}
+
+bool ClothSim::_update_projective_substep(float h) {
+    if(!_projective_key.built || _projective_key.n != _n || _projective_key.scale != _scale
+        || _projective_key.fpa != _fpa || _projective_key.time_step != h
+        || _projective_key.version != _system_version) {
+        std::vector<physics::distance_constraint> edges;
+        _active_distance_constraints(edges);
+        _projective.build(_particles, edges, h);
+        _projective_key.n = _n;
+        _projective_key.scale = _scale;
+        _projective_key.fpa = _fpa;
+        _projective_key.time_step = h;
+        _projective_key.version = _system_version;
+        _projective_key.built = true;
+        _projective_key.failed = _projective.empty();
+    }
+    if(_projective_key.failed)
+        return false;
+    _projective.step(_particles, _a_gravity, _f_wind, _num_phys_iterations);
+    // the grab is not part of the factored system, it is projected after
+    if(!_grab.empty())
+        physics::solve_grab(_particles, _grab, _islands.asleep_mask);
+    _resolve_colliders();
+    _resolve_plane_intersections();
+    _step_stats.iterations += _num_phys_iterations;
+    return true;
+}
+
+void ClothSim::_update_implicit_substep(float h) {
+    // the sparsity pattern follows the edges, pins only change the values
+    if(_implicit_dirty) {
+        std::vector<physics::distance_constraint> edges;
+        _active_distance_constraints(edges);
+        _implicit.build(_particles.size(), edges);
+        _implicit_dirty = false;
+    }
+    _step_stats.iterations += _implicit.step(_particles, _a_gravity, _f_wind, h, IMPLICIT_MAX_CG_ITERATIONS, IMPLICIT_CG_TOLERANCE);
+    // the grab is not part of the spring system, it is projected after
+    if(!_grab.empty())
+        physics::solve_grab(_particles, _grab, _islands.asleep_mask);
+    _resolve_colliders();
+    _resolve_plane_intersections();
+}
+
+void ClothSim::_solve_constraints() {
+    // every sweep reports its error, only the last one is kept
+    // - the adaptive mode stops as soon as a sweep is within tolerance,
+    //   capped at _num_phys_iterations sweeps
+    // - chebyshev acceleration extrapolates every sweep (or tiled pass), and
+    //   falls back to a plain warm-up when the error blows up
+    physics::constraint_error err;
+    err.clear();
+    double prev_sum_sq = 0;
+    size_type iterations = 0;
+    size_type resolved = 0;
+    // coarse levels first, the sweeps below are the fine level
+    if(_solver_strategy == Multigrid)
+        resolved += physics::solve_multigrid(_particles, _multigrid, _islands.asleep_mask, MULTIGRID_LEVEL_ITERATIONS);
+    if(_chebyshev_acceleration)
+        _chebyshev.begin(_particles);
+    bool offset = false;
+    while(iterations < _num_phys_iterations) {
+        err.clear();
+        if(_solver_strategy == Tiled) {
+            // a tiled pass is the smallest unit of work
+            const physics::constraint_set& tiles = offset ? _constraints_offset : _constraints;
+            size_type local = std::min(_num_phys_iterations - iterations, TILE_LOCAL_ITERATIONS);
+            resolved += physics::solve_tiled_pass(_particles, tiles, local, _active_multipliers(), &err);
+            iterations += local;
+            offset = !offset;
+        }
+        else {
+            resolved += _resolve_physics_constraints(&err);
+            iterations++;
+        }
+        // the grab is one more constraint per grabbed particle, projected
+        // after every sweep (or tiled pass) so the next one answers it
+        if(!_grab.empty())
+            physics::solve_grab(_particles, _grab, _islands.asleep_mask);
+        if(!err.overstretched.empty())
+            _pending_edges.insert(_pending_edges.end(), err.overstretched.begin(), err.overstretched.end());
+        if(_adaptive_iterations && _within_error_tolerance(err))
+            break;
+        if(_chebyshev_acceleration) {
+            if(_chebyshev.omega != 1.0f && err.sum_sq > CHEBYSHEV_DIVERGENCE_RATIO*prev_sum_sq)
+                _chebyshev.restart();
+            _chebyshev.accelerate(_particles);
+            prev_sum_sq = err.sum_sq;
+        }
+    }
+    // telemetry accumulates over the substeps of update_physics()
+    _step_stats.iterations += iterations;
+    _step_stats.resolved += resolved;
+    _step_stats.max_error = err.max;
+    // asleep islands are not swept, they add nothing to sum_sq
+    _step_stats.rms_error = _num_swept_edges ? std::sqrt(err.sum_sq/_num_swept_edges) : 0.0f;
+}
+
+void ClothSim::_update_sleep() {
+    // islands are as fast as their fastest particle over the last substep
+    if(_islands_dirty)
+        _init_islands();
+    float max_disp = SLEEP_SPEED*_scale*_time_step/_num_substeps;
+    std::vector<size_type> fell_asleep;
+    _islands.update_sleep(_particles, max_disp*max_disp, SLEEP_STEPS, fell_asleep);
+    // an island that falls asleep only gives up its slots, the constraints
+    // are rebuilt once enough of them are dead (as for erasures)
+    for(auto it=fell_asleep.begin(); it!=fell_asleep.end(); ++it) {
+        for(size_type k=_islands.begin[*it]; k<_islands.end[*it]; k++) {
+            const cloth_vertex& vert = _vertices[_islands.particles[k]];
+            for(auto e=vert.edge_indices.begin(); e!=vert.edge_indices.end(); ++e)
+                _unslot_edge(*e);
+        }
+    }
+    if(!fell_asleep.empty() && _num_swept_edges < COMPACTION_RATIO*_num_slotted_edges)
+        _sleep_dirty = true;
+}
+
+void ClothSim::_resolve_self_collisions() {
+    if(_self_collision_dirty)
+        _init_self_collision();
+    float thickness = SELF_COLLISION_THICKNESS*_scale/_n;
+    const physics::island_set* islands = _sleeping ? &_islands : nullptr;
+    // adjacent pairs are looked up in the vertices' own edge lists
+    size_type num_contacts = _self_collisions.find_contacts(_particles, thickness,
+        [this](size_type a, size_type b) { return _shares_edge(a, b); }, _thread_pool, islands);
+    _step_stats.contacts += num_contacts;
+    // whatever lands on a sleeping island wakes it
+    if(islands) {
+        const std::vector<physics::self_collision_set::contact>& contacts = _self_collisions.contacts;
+        for(auto it=contacts.begin(); it!=contacts.end(); ++it) {
+            _wake_vertex(it->a);
+            _wake_vertex(it->b);
+        }
+    }
+    physics::solve_self_collisions(_particles, _self_collisions, thickness, SELF_COLLISION_ITERATIONS);
+}
+
+void ClothSim::_resolve_colliders() {
+    float margin = COLLIDER_MARGIN*_scale/_n;
+    if(!_colliders.empty())
+        physics::resolve_colliders(_particles, _colliders, _islands.asleep_mask, margin, _thread_pool);
+    for(auto it=_mesh_colliders.begin(); it!=_mesh_colliders.end(); ++it)
+        physics::resolve_mesh_collider(_particles, *it, _islands.asleep_mask, margin, _thread_pool);
+}
+
+void ClothSim::_wake_vertex(size_type v) {
+    if(_islands.wake_particle(v))
+        _sleep_dirty = true;
+}
+
+bool ClothSim::_within_error_tolerance(const physics::constraint_error& err) const {
+    if(err.max > _error_tolerance)
+        return false;
+    // rms tolerance of 0 disables the check
+    if(_rms_error_tolerance > 0 && _num_swept_edges > 0)
+        return err.sum_sq <= (double)_rms_error_tolerance*_rms_error_tolerance*_num_swept_edges;
+    return true;
+}
+
+ClothSim::size_type ClothSim::_resolve_physics_constraints(physics::constraint_error* err) {
+    // vectorized projection of every batch, see constraint_kernel.h
+    switch(_solver_strategy) {
+        case Colored:
+            return physics::solve_colored_sweep(_particles, _constraints, _thread_pool, _active_multipliers(), err);
+        case Jacobi:
+            return physics::solve_jacobi_sweep(_particles, _constraints, _jacobi, _thread_pool, JACOBI_RELAXATION, _active_multipliers(), err);
+        // case GaussSeidel:
+        default:
+            return physics::solve_constraints(_particles, _constraints, _active_multipliers(), 0, _constraints.size(), err);
+    }
+}
+
+physics::xpbd_multipliers* ClothSim::_active_multipliers() {
+    return _constraint_model == Xpbd ? &_multipliers : nullptr;
+}
+
+void ClothSim::_resolve_plane_intersections() {
+    typedef physics::particle_set::mask_word mask_word;
+    const size_type word_bits = physics::particle_set::MASK_WORD_BITS;
+    // same walk as the verlet loop, erased and asleep particles cost only
+    // their share of a mask word
+    for(size_type w=0; w<_particles.pinned.size(); w++) {
+        mask_word asleep = w < _islands.asleep_mask.size() ? _islands.asleep_mask[w] : 0;
+        mask_word free_bits = ~(_particles.pinned[w] | asleep);
+        while(free_bits) {
+            size_type i = w*word_bits + __builtin_ctz(free_bits);
+            free_bits &= free_bits - 1;
+            _resolve_plane_intersection(_particles.pos[i], _particles.pos_old[i]);
+        }
+    }
+}
+
+bool ClothSim::_resolve_plane_intersection(glm::vec3& pos, const glm::vec3& pos_old) {
+    float floor_y = _scale*FLOOR_PLANE_Y;
+    if(pos.y >= floor_y)
+        return false;
+
+    glm::vec3 frame_path = pos - pos_old;
+    float ratio = std::abs((floor_y - pos.y) / frame_path.y);
+    frame_path *= ratio;
+    pos -= frame_path;
+    frame_path.y = 0;
+    frame_path *= FLOOR_PLANE_FRICTION_COEFF;
+    pos += frame_path;
+    pos.y = floor_y + 0.0001f;
+    return true;
+}
+
+
+
+
+/* ============================================================================ *
+ * Private Functions - Mesh Manipulation
+ * ============================================================================ */
+void ClothSim::_commit_erasures() {
+    if(_pending_edges.empty() && _pending_vertices.empty())
+        return;
+    // worklist over both queues, an erased edge may orphan its vertices and
+    // an erased vertex takes all of its edges with it
+    size_type num_erased = 0;
+    // islands that lose an edge or a particle, while they are kept
+    bool track_islands = _sleeping && !_islands_dirty;
+    std::vector<size_type> touched;
+    while(!_pending_edges.empty() || !_pending_vertices.empty()) {
+        if(!_pending_vertices.empty()) {
+            cloth_vertex& vert = _vertices[_pending_vertices.back()];
+            _pending_vertices.pop_back();
+            if(!vert.active)
+                continue;
+            vert.active = false;
+            // pin erased vertices so the integrator skips them
+            _particles.set_pinned(vert.index, true);
+            _erased_mask[vert.index/physics::particle_set::MASK_WORD_BITS] |= 1u << (vert.index%physics::particle_set::MASK_WORD_BITS);
+            _picking_dirty = true;
+            if(track_islands && _islands.island_of[vert.index] != physics::island_set::NO_ISLAND)
+                touched.push_back(_islands.island_of[vert.index]);
+            _pending_edges.insert(_pending_edges.end(), vert.edge_indices.begin(), vert.edge_indices.end());
+            continue;
+        }
+        cloth_edge& edge = _edges[_pending_edges.back()];
+        _pending_edges.pop_back();
+        if(!edge.active)
+            continue;
+        // a tear wakes its island (both ends are in the same one)
+        _wake_vertex(edge.vertex_a);
+        edge.active = false;
+        num_erased++;
+        if(track_islands && _islands.island_of[edge.vertex_a] != physics::island_set::NO_ISLAND)
+            touched.push_back(_islands.island_of[edge.vertex_a]);
+        _unslot_edge(edge.index);
+        _detach_edge(_vertices[edge.vertex_a], edge.index);
+        _detach_edge(_vertices[edge.vertex_b], edge.index);
+    }
+    if(num_erased) {
+        // invalidate everything built from the topology once per commit
+        _num_active_edges -= num_erased;
+        _attachments_dirty = true;
+        _multigrid_dirty = true;
+        _implicit_dirty = true;
+        _system_version = ++_system_version_counter;
+        _topology_version++;
+        _self_collision_dirty = true;
+        // drop the dead slots and vertices once enough have piled up, so a
+        // torn cloth costs about as much as an intact one of its size
+        if(_num_swept_edges < COMPACTION_RATIO*_num_slotted_edges) {
+            _init_constraints();
+            _init_active_vertices();
+        }
+    }
+    if(!touched.empty())
+        _split_islands(touched);
+}
+
+void ClothSim::_unslot_edge(size_type e) {
+    if(e < _constraints.slot.size() && _constraints.slot[e] != physics::constraint_set::NO_SLOT)
+        _num_swept_edges--;
+    _constraints.disable(e);
+    _constraints_offset.disable(e);
+}
+
+void ClothSim::_split_islands(std::vector<size_type>& islands) {
+    std::sort(islands.begin(), islands.end());
+    islands.erase(std::unique(islands.begin(), islands.end()), islands.end());
+    std::vector<size_type> members;
+    std::vector<physics::distance_constraint> edges;
+    for(auto it=islands.begin(); it!=islands.end(); ++it) {
+        // what is left of the island, each live edge once from its first end
+        members.clear();
+        edges.clear();
+        for(size_type k=_islands.begin[*it]; k<_islands.end[*it]; k++) {
+            const cloth_vertex& vert = _vertices[_islands.particles[k]];
+            if(!vert.active)
+                continue;
+            members.push_back(vert.index);
+            for(auto e=vert.edge_indices.begin(); e!=vert.edge_indices.end(); ++e) {
+                const cloth_edge& edge = _edges[*e];
+                if(edge.vertex_a == vert.index)
+                    edges.push_back({edge.vertex_a, edge.vertex_b, edge.resting_length, edge.flex_coeff, edge.compliance, edge.color});
+            }
+        }
+        _islands.split(*it, members, edges);
+    }
+}
+
+bool ClothSim::_shares_edge(size_type a, size_type b) const {
+    const vertex_edge_list& edges = _vertices[a].edge_indices;
+    for(auto it=edges.begin(); it!=edges.end(); ++it) {
+        const cloth_edge& edge = _edges[*it];
+        if(edge.vertex_a == b || edge.vertex_b == b)
+            return true;
+    }
+    return false;
+}
+
+void ClothSim::_active_distance_constraints(std::vector<physics::distance_constraint>& out) const {
+    out.clear();
+    out.reserve(_num_active_edges);
+    for(auto it=_edges.begin(); it!=_edges.end(); ++it) {
+        if(it->active)
+            out.push_back({it->vertex_a, it->vertex_b, it->resting_length, it->flex_coeff, it->compliance, it->color});
+    }
+}
+
+void ClothSim::_detach_edge(cloth_vertex& v, size_type e) {
+    // a vertex that loses an edge loses the bending edge behind it, and the
+    // diagonals that no longer have a neighbor edge on either side
+    v.edge_indices.erase(e);
+    if(v.edge_up == e) {
+        v.edge_up = -1;
+        if(v.edge_2up >= 0) _pending_edges.push_back(v.edge_2up);
+    }
+    if(v.edge_right == e) {
+        v.edge_right = -1;
+        if(v.edge_2right >= 0) _pending_edges.push_back(v.edge_2right);
+    }
+    if(v.edge_down == e) {
+        v.edge_down = -1;
+        if(v.edge_2down >= 0) _pending_edges.push_back(v.edge_2down);
+    }
+    if(v.edge_left == e) {
+        v.edge_left = -1;
+        if(v.edge_2left >= 0) _pending_edges.push_back(v.edge_2left);
+    }
+    if(v.edge_diag_al == e)  v.edge_diag_al = -1;
+    if(v.edge_diag_ar == e)  v.edge_diag_ar = -1;
+    if(v.edge_diag_bl == e)  v.edge_diag_bl = -1;
+    if(v.edge_diag_br == e)  v.edge_diag_br = -1;
+    if(v.edge_up < 0) {
+        if(v.edge_left < 0 && v.edge_diag_al >= 0)
+            _pending_edges.push_back(v.edge_diag_al);
+        if(v.edge_right < 0 && v.edge_diag_ar >= 0)
+            _pending_edges.push_back(v.edge_diag_ar);
+    }
+    if(v.edge_down < 0) {
+        if(v.edge_left < 0 && v.edge_diag_bl >= 0)
+            _pending_edges.push_back(v.edge_diag_bl);
+        if(v.edge_right < 0 && v.edge_diag_br >= 0)
+            _pending_edges.push_back(v.edge_diag_br);
+    }
+    // check if the vertex should be erased
+    if((v.edge_up < 0 && v.edge_down < 0) || (v.edge_left < 0 && v.edge_right < 0))
+        _pending_vertices.push_back(v.index);
+}
+
+
+
+/* ============================================================================ *
+ * Private Functions - Picking
+ * ============================================================================ */
+void ClothSim::_refit_picking() {
+    if(_picking_dirty) {
+        _picking.refit(_particles, _erased_mask, _thread_pool);
+        _picking_dirty = false;
+    }
+}
+
+// bool ClothSim::_split_vertex(size_type v, bool horizontal) {
+//     return _split_vertex(_vertices[v], horizontal);
+// }
+
+// bool ClothSim::_split_vertex(cloth_vertex& v, bool horizontal) {
+//     return horizontal ? _split_vertex_horizontal(v) : _split_vertex_vertical(v);
+// }
+
+// bool ClothSim::_split_vertex_horizontal(cloth_vertex& v) {
+//     if(v.edge_up < 0 || v.edge_down < 0)
+//         return false;
+//     _vertices.push_back(v);
+//     cloth_vertex& new_v = _vertices.back();
+//     v.edge_down = -1;
+//     new_v.index = _vertices.size()-1;
+//     new_v.edge_indices.erase(new_v.edge_up);
+//     new_v.edge_up = -1;
+//     cloth_edge& e_down = _edges[new_v.edge_down];
+//     if(e_down.vertex_a == v.index)
+//         e_down.vertex_a = new_v.index;
+//     else
+//         e_down.vertex_b = new_v.index;
+//     return true;
+// }
+
+// bool ClothSim::_split_vertex_vertical(cloth_vertex& v) {
+//     return false;
+// }
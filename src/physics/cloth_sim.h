@@ -0,0 +1,441 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: cloth_sim.h
+ *  Header file for ClothSim class (headless cloth simulation)
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: ClothSim owns everything needed to step a cloth: integration,
+ *  constraint solving, collision and tearing. It has no SFML or OpenGL
+ *  dependency and is built into libclothphysics.a (`make physics`); the GUI
+ *  Cloth component is a thin adapter that renders and drives one ClothSim.
+ *  All positions are in the simulation's model space.
+ *
+ *  Two constraint models are available. FlexBand (the original) only corrects
+ *  lengths outside of a +-flex_coeff band, so its stiffness grows with the
+ *  iteration count and shrinks with the time step. Xpbd projects every edge
+ *  with a compliance (inverse stiffness, m/N) and per-step multipliers, so
+ *  the material converges to the same stiffness at any iteration count.
+ *  Gauss-Seidel converges slowly along long chains, so a few substeps of a
+ *  few sweeps each (set_substeps) reach that stiffness for much less work
+ *  than many sweeps of one full step.
+ *
+ *  The Jacobi strategy (see jacobi.h) is the only one whose result does not
+ *  depend on the thread count; it needs more sweeps than Gauss-Seidel but
+ *  every sweep is split evenly across the pool.
+ * ---------------------------------------------------------------------------- */
+
+#ifndef CLOTH_SIM_H
+#define CLOTH_SIM_H
+
+#include "../../lib/glm/vec3.hpp"
+
+#include "particles.h"
+#include "constraints.h"
+#include "constraint_kernel.h"
+#include "chebyshev.h"
+#include "attachments.h"
+#include "multigrid.h"
+#include "projective.h"
+#include "implicit.h"
+#include "jacobi.h"
+#include "islands.h"
+#include "self_collision.h"
+#include "colliders.h"
+#include "mesh_collider.h"
+#include "picking.h"
+#include "grab.h"
+#include "thread_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ClothSim {
+public:
+    // typdefs
+    typedef std::size_t size_type;
+
+public:
+    // static constants
+    static const size_type DEFAULT_SIDE_VERTEX_COUNT;
+    static const size_type PHYSICS_ITERATIONS;
+    static const float DEFAULT_TIME_STEP;
+    static const float NEIGHBOR_FLEX_COEFF;
+    static const float BENDING_FLEX_COEFF;
+    static const float NEIGHBOR_COMPLIANCE;
+    static const float BENDING_COMPLIANCE;
+    static const float NEIGHBOR_TEAR_THRESH;
+    static const float FLOOR_PLANE_Y;
+    static const float FLOOR_PLANE_FRICTION_COEFF;
+    static const unsigned EDGE_COLOR_COUNT;
+    static const size_type TILE_SIDE_VERTEX_COUNT;
+    static const size_type TILE_LOCAL_ITERATIONS;
+    static const float DEFAULT_ERROR_TOLERANCE;
+    static const float DEFAULT_RMS_ERROR_TOLERANCE;
+    static const float DEFAULT_SPECTRAL_RADIUS;
+    static const size_type CHEBYSHEV_WARMUP_ITERATIONS;
+    static const float CHEBYSHEV_DIVERGENCE_RATIO;
+    static const float ATTACHMENT_SLACK;
+    static const size_type MULTIGRID_MIN_SIDE_VERTEX_COUNT;
+    static const size_type MULTIGRID_LEVEL_ITERATIONS;
+    static const size_type IMPLICIT_MAX_CG_ITERATIONS;
+    static const float IMPLICIT_CG_TOLERANCE;
+    static const float JACOBI_RELAXATION;
+    static const float COMPACTION_RATIO;
+    static const float SLEEP_SPEED;
+    static const size_type SLEEP_STEPS;
+    static const float SELF_COLLISION_THICKNESS;
+    static const size_type SELF_COLLISION_ITERATIONS;
+    static const float COLLIDER_MARGIN;
+    static const float GRAB_COMPLIANCE;
+    // - edges of a grid vertex: 4 neighbor, 4 diagonal and 4 bending ones
+    static const unsigned MAX_VERTEX_EDGES = 12;
+
+    // enums
+    enum FixedPointArrangement {
+        Curtain=0,
+        FlagLeft,
+        FlatRight,
+        FourCorners,
+        AllTop,
+        AllLeft,
+        AllRight,
+        AllLeftRight,
+        AllPerimeter,
+        Loose
+    };
+    enum SolverStrategy {
+        GaussSeidel=0,
+        Colored,
+        Tiled,
+        Multigrid,
+        Jacobi
+    };
+    enum ConstraintModel {
+        FlexBand=0,
+        Xpbd
+    };
+    enum Integrator {
+        Verlet=0,
+        ProjectiveDynamics,
+        ImplicitEuler
+    };
+
+    // structs
+    // - inline edge indices of a vertex, kept in ascending order
+    struct vertex_edge_list {
+        int index[MAX_VERTEX_EDGES];
+        unsigned count;
+
+        bool empty() const;
+        const int* begin() const;
+        const int* end() const;
+        void clear();
+        void insert(int e);
+        void erase(int e);
+    };
+    // - topology only, solver state lives in the particle set
+    struct cloth_vertex {
+        vertex_edge_list edge_indices;
+        int edge_up;
+        int edge_right;
+        int edge_down;
+        int edge_left;
+        int edge_diag_al;
+        int edge_diag_ar;
+        int edge_diag_bl;
+        int edge_diag_br;
+        int edge_2up;
+        int edge_2right;
+        int edge_2down;
+        int edge_2left;
+        size_type index;
+        float mass;
+        bool active;
+    };
+    struct cloth_edge {
+        size_type vertex_a;
+        size_type vertex_b;
+        size_type index;
+        float flex_coeff;
+        float compliance;
+        float resting_length;
+        unsigned color;
+        bool active;
+    };
+    // - telemetry of the last update_physics(), summed over its substeps
+    struct step_stats {
+        size_type iterations; // constraint sweeps
+        size_type resolved;   // constraints corrected over all sweeps
+        float max_error;      // of the last sweep, relative to rest length
+        float rms_error;
+        size_type contacts;   // self-collision pairs found
+    };
+
+private:
+    // private data members
+    size_type _n; // side vertex count
+    float _scale;
+    physics::particle_set _particles;
+    physics::constraint_set _constraints;
+    physics::constraint_set _constraints_offset; // offset tiling (Tiled only)
+    physics::xpbd_multipliers _multipliers; // Xpbd only, indexed by edge
+    physics::chebyshev_accelerator _chebyshev;
+    physics::attachment_set _attachments;
+    physics::multigrid_hierarchy _multigrid; // Multigrid only
+    physics::projective_system _projective; // ProjectiveDynamics only
+    physics::implicit_system _implicit; // ImplicitEuler only
+    physics::jacobi_buffers _jacobi; // Jacobi only
+    physics::island_set _islands; // sleeping only
+    physics::self_collision_set _self_collisions; // self-collision only
+    physics::collider_set _colliders;
+    std::vector<physics::mesh_collider> _mesh_colliders;
+    physics::pick_hierarchy _picking;
+    physics::grab_set _grab;
+    // - one bit per erased vertex, same layout as particle_set::pinned
+    physics::aligned_vector<physics::particle_set::mask_word> _erased_mask;
+    std::vector<cloth_vertex> _vertices;
+    std::vector<cloth_edge> _edges;
+    glm::vec3 _a_gravity;
+    glm::vec3 _f_wind;
+    float _air_resist;
+    float _time_step;
+    double _time_simulated;
+
+    FixedPointArrangement _fpa;
+    size_type _num_phys_iterations;
+    size_type _num_substeps;
+    bool _adaptive_iterations;
+    float _error_tolerance;
+    float _rms_error_tolerance;
+    bool _chebyshev_acceleration;
+    bool _long_range_attachments;
+    bool _tearing;
+    bool _sleeping;
+    bool _self_collision;
+    bool _islands_dirty; // topology changed since the last build
+    bool _sleep_dirty; // an island woke, or enough fell asleep, since the last constraint build
+    bool _self_collision_dirty; // topology changed since the last build
+    bool _attachments_dirty; // pins or topology changed since the last build
+    bool _multigrid_dirty; // topology changed since the last build
+    bool _implicit_dirty; // topology changed since the last build
+    bool _picking_dirty; // particles moved since the last refit
+    // - the projective system is factored for (n, scale, fpa, time step) and
+    //   the pins and edges at _system_version, which is 0 right after a
+    //   restart and takes a fresh value on every later pin or edge change;
+    //   a failed build is remembered under its key and not retried
+    size_type _system_version;
+    size_type _system_version_counter;
+    // - changes on every committed erasure and restart, for derived data
+    //   kept outside of the simulation (render meshes)
+    size_type _topology_version;
+    // - erasures queued for the next commit, also the commit's worklist
+    std::vector<size_type> _pending_edges;
+    std::vector<size_type> _pending_vertices;
+    struct {
+        size_type n;
+        float scale;
+        FixedPointArrangement fpa;
+        float time_step;
+        size_type version;
+        bool built;
+        bool failed;
+    } _projective_key;
+    size_type _num_active_edges;
+    size_type _num_slotted_edges; // edges given a slot at the last constraint build
+    size_type _num_swept_edges; // slotted edges not erased since, the rms error's count
+    // - ascending, may hold vertices erased since the last compaction
+    std::vector<size_type> _active_vertices;
+    step_stats _step_stats;
+    SolverStrategy _solver_strategy;
+    ConstraintModel _constraint_model;
+    Integrator _integrator;
+    ThreadPool _thread_pool;
+
+public:
+    // constructors
+    ClothSim(float scale=1.0f, size_type side_vertex_count=DEFAULT_SIDE_VERTEX_COUNT);
+    ClothSim(const ClothSim& o) = delete;
+
+    // assignment
+    ClothSim& operator=(const ClothSim& o) = delete;
+
+    // accessors
+    float get_time_step() const;
+    double get_time_simulated() const;
+    float get_scale() const;
+    size_type get_n_vertices() const;
+    FixedPointArrangement get_fixed_point_arrangement() const;
+    size_type get_phys_iterations() const;
+    size_type get_substeps() const;
+    bool get_adaptive_iterations() const;
+    float get_error_tolerance() const;
+    float get_rms_error_tolerance() const;
+    bool get_chebyshev_acceleration() const;
+    float get_spectral_radius() const;
+    size_type get_chebyshev_warmup() const;
+    bool get_long_range_attachments() const;
+    bool get_tearing() const;
+    bool get_sleeping() const;
+    bool get_self_collision() const;
+    SolverStrategy get_solver_strategy() const;
+    ConstraintModel get_constraint_model() const;
+    Integrator get_integrator() const;
+    size_type get_num_threads() const;
+
+    // state accessors
+    const physics::particle_set& get_particles() const;
+    const std::vector<cloth_vertex>& get_vertices() const;
+    const std::vector<cloth_edge>& get_edges() const;
+    size_type get_num_active_edges() const;
+    size_type get_topology_version() const;
+    // - ascending, a superset of the active vertices that drops erased ones
+    //   whenever tearing triggers a compaction
+    const std::vector<size_type>& get_active_vertices() const;
+    const physics::island_set& get_islands() const;
+    const physics::collider_set& get_colliders() const;
+    const std::vector<physics::mesh_collider>& get_mesh_colliders() const;
+    const physics::grab_set& get_grab() const;
+    const step_stats& get_step_stats() const;
+
+    // mutators
+    void set_fixed_point(size_type v, bool fixed);
+    void set_vertex_position(size_type v, const glm::vec3& pos);
+    void set_gravity(const glm::vec3& gravity);
+    void set_wind_force(const glm::vec3& wind);
+    void set_time_step(float time_step);
+    void set_scale(float scale);
+    void set_n_vertices(size_type n);
+    void set_fixed_point_arrangement(FixedPointArrangement fpa);
+    void set_phys_iterations(size_type num_iters);
+    // - splits each time step into substeps of `num_iters` sweeps each
+    void set_substeps(size_type num_substeps);
+    // - adaptive: sweep until the error is within tolerance, at most
+    //   get_phys_iterations() sweeps per substep
+    void set_adaptive_iterations(bool adaptive);
+    void set_error_tolerance(float max_error, float rms_error=DEFAULT_RMS_ERROR_TOLERANCE);
+    // - chebyshev: extrapolates each sweep after `warmup` plain ones, rho is
+    //   the estimated spectral radius of a plain sweep (see chebyshev.h)
+    void set_chebyshev_acceleration(bool accelerate);
+    void set_spectral_radius(float rho, size_type warmup=CHEBYSHEV_WARMUP_ITERATIONS);
+    // - long-range attachments: tethers every free vertex to its nearest
+    //   pinned one (see attachments.h), rebuilt whenever pins or edges change
+    void set_long_range_attachments(bool attach);
+    // - tearing: neighbor edges stretched past NEIGHBOR_TEAR_THRESH times
+    //   their rest length during the sweeps of a step are erased at the end
+    //   of it (Verlet only)
+    void set_tearing(bool tear);
+    // - sleeping: islands (pieces of torn cloth) that stay slower than
+    //   SLEEP_SPEED for SLEEP_STEPS steps are no longer integrated or solved
+    //   until grabbed, torn, pinned, or gravity or wind change (Verlet only)
+    void set_sleeping(bool sleep);
+    // - self-collision: keeps particles that share no edge at least
+    //   SELF_COLLISION_THICKNESS rest spacings apart (see self_collision.h),
+    //   the spatial hash is rebuilt every substep (Verlet only)
+    void set_self_collision(bool collide);
+    void set_solver_strategy(SolverStrategy strategy);
+    void set_constraint_model(ConstraintModel model);
+    // - projective dynamics: implicit steps with a prefactored system, for
+    //   fixed topology (tearing refactors it), phys_iterations local/global
+    //   iterations per substep
+    // - implicit euler: linearized implicit steps of the edges as springs,
+    //   stable at much larger time steps for stiff cloth
+    void set_integrator(Integrator integrator);
+    void set_num_threads(size_type num_threads);
+    // - colliders: static shapes (see colliders.h) in model space, resolved
+    //   after the constraints of every substep with a margin of
+    //   COLLIDER_MARGIN rest spacings, kept across restarts
+    size_type add_collider(const physics::collider& c);
+    // - triangle meshes (see mesh_collider.h), three indices per triangle,
+    //   continuous sweeps each particle's motion over the substep (see there)
+    size_type add_mesh_collider(const std::vector<glm::vec3>& vertices, const std::vector<std::uint32_t>& indices, float friction, bool continuous=true);
+    // - removes shape and mesh colliders
+    void clear_colliders();
+
+    // graph accessors
+    size_type edge_connection(size_type e, size_type v) const;
+    size_type edge_connection(const cloth_edge& e, size_type v) const;
+
+    // update functions
+    void update_physics();
+    void restart();
+
+    // mesh manipulation
+    // - erasures are queued and committed in one batch at the start of the
+    //   next update_physics(), or by commit_erasures()
+    bool erase_vertex(size_type v);
+    void commit_erasures();
+
+    // picking
+    // - nearest active vertex whose sphere of `radius` the model space ray
+    //   origin + t*dir (t >= 0) hits (see picking.h), refitting the
+    //   hierarchy first if the particles moved since the last pick
+    // - returns whether there was one, and the vertex and t
+    bool pick_vertex(const glm::vec3& origin, const glm::vec3& dir, float radius, size_type& v, float& t);
+    // - appends every active vertex within the model space `radius` of
+    //   center to out, ascending, through the same hierarchy
+    // - returns the number appended
+    size_type vertices_within(const glm::vec3& center, float radius, std::vector<size_type>& out);
+
+    // grabbing
+    // - attaches the active vertices given at their offsets from the model
+    //   space target with a compliant constraint of GRAB_COMPLIANCE (see
+    //   grab.h), ending any grab before; grabbed pins come loose
+    void begin_grab(const std::vector<size_type>& vertices, const glm::vec3& target);
+    // - the target at `time`, in simulated time (see get_time_simulated()),
+    //   every substep interpolates it between the samples around its end
+    void set_grab_target(double time, const glm::vec3& target);
+    // - moves the grabbed vertices onto target right away, for when no
+    //   steps run to move them (e.g. while paused)
+    void place_grab(const glm::vec3& target);
+    // - lets go of the grabbed vertices, or pins them where they are
+    void end_grab(bool pin=false);
+    bool is_grabbing() const;
+
+private:
+    // private functions
+    // - initialization
+    void _initialize_cloth_vertices();
+    void _init_fixed_points();
+    void _add_edges_init_vertex(size_type v, int r, int c);
+    size_type _add_edge(size_type a, size_type b, float length, float flex_coeff, float compliance, unsigned color);
+    void _init_constraints();
+    void _init_active_vertices();
+    void _init_islands();
+    void _init_self_collision();
+    void _init_attachments();
+    void _init_multigrid();
+    // - constraint resolving
+    void _update_substep(float h);
+    bool _update_projective_substep(float h);
+    void _update_implicit_substep(float h);
+    void _solve_constraints();
+    void _update_sleep();
+    void _resolve_self_collisions();
+    void _resolve_colliders();
+    void _wake_vertex(size_type v);
+    bool _within_error_tolerance(const physics::constraint_error& err) const;
+    size_type _resolve_physics_constraints(physics::constraint_error* err);
+    physics::xpbd_multipliers* _active_multipliers();
+    bool _resolve_plane_intersection(glm::vec3& pos, const glm::vec3& pos_old);
+    void _resolve_plane_intersections();
+    // - mesh manipulation
+    void _commit_erasures();
+    void _detach_edge(cloth_vertex& v, size_type e);
+    // - takes an edge out of the constraint slots until the next build
+    void _unslot_edge(size_type e);
+    // - re-splits the (possibly repeated) islands touched by a commit
+    void _split_islands(std::vector<size_type>& islands);
+    // - whether a live edge joins a and b
+    bool _shares_edge(size_type a, size_type b) const;
+    // - every active edge, for the structures built from the live topology
+    void _active_distance_constraints(std::vector<physics::distance_constraint>& out) const;
+    // - picking
+    void _refit_picking();
+};
+
+#endif
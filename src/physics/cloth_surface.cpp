@@ -0,0 +1,108 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: cloth_surface.cpp
+ *  Definition file for the surface (normals and triangles) of a ClothSim
+ * **************************************************************************** */
+
+#include "cloth_surface.h"
+
+#include "../../lib/glm/geometric.hpp"
+#include "../../lib/glm/gtx/vector_angle.hpp"
+
+/* ============================================================================ *
+ * Surface Sizes
+ * ============================================================================ */
+std::size_t physics::max_triangle_vertices(const ClothSim& sim) {
+    std::size_t n = sim.get_n_vertices();
+    return (n-1)*(n-1)*6;
+}
+
+
+
+/* ============================================================================ *
+ * Surface Passes
+ * ============================================================================ */
+void physics::compute_normals(const ClothSim& sim, std::vector<glm::vec3>& normals) {
+    typedef std::size_t size_type;
+    const std::vector<ClothSim::cloth_vertex>& vertices = sim.get_vertices();
+    const particle_set& particles = sim.get_particles();
+    size_type n = sim.get_n_vertices();
+    const std::vector<size_type>& active = sim.get_active_vertices();
+    normals.assign(vertices.size(), glm::vec3(0,0,0));
+    // quads by their bottom left vertex, which must be active
+    for(auto it=active.begin(); it!=active.end(); ++it) {
+        size_type bl = *it;
+        if(bl < n || bl%n == n-1)
+            continue;
+        size_type br = bl + 1;
+        size_type al = bl - n;
+        size_type ar = bl - n + 1;
+        const glm::vec3& bl_pos = particles.pos[bl];
+        const glm::vec3& br_pos = particles.pos[br];
+        const glm::vec3& al_pos = particles.pos[al];
+        const glm::vec3& ar_pos = particles.pos[ar];
+        if(vertices[bl].active && vertices[ar].active) {
+            if(vertices[al].active) {
+                glm::vec3 edge_1 = bl_pos-al_pos;
+                glm::vec3 edge_2 = ar_pos-al_pos;
+                glm::vec3 edge_3 = bl_pos-ar_pos;
+                glm::vec3 p = glm::cross(edge_1, edge_2);
+                edge_1 = glm::normalize(edge_1);
+                edge_2 = glm::normalize(edge_2);
+                edge_3 = glm::normalize(edge_3);
+                normals[bl] += p*glm::angle(edge_1, edge_3);
+                normals[al] += p*glm::angle(edge_1, edge_2);
+                normals[ar] += p*glm::angle(-edge_2, edge_3);
+            }
+            if(vertices[br].active) {
+                glm::vec3 edge_1 = ar_pos-br_pos;
+                glm::vec3 edge_2 = bl_pos-br_pos;
+                glm::vec3 edge_3 = bl_pos-ar_pos;
+                glm::vec3 p = glm::cross(edge_1, edge_2);
+                edge_1 = glm::normalize(edge_1);
+                edge_2 = glm::normalize(edge_2);
+                edge_3 = glm::normalize(edge_3);
+                normals[bl] += p*glm::angle(edge_2, edge_3);
+                normals[br] += p*glm::angle(edge_1, edge_2);
+                normals[ar] += p*glm::angle(-edge_1, edge_3);
+            }
+        }
+    }
+}
+
+std::size_t physics::compute_triangles(const ClothSim& sim, const std::vector<glm::vec3>& normals, surface_vertex* out) {
+    typedef std::size_t size_type;
+    const std::vector<ClothSim::cloth_vertex>& vertices = sim.get_vertices();
+    const particle_set& particles = sim.get_particles();
+    const std::vector<size_type>& active = sim.get_active_vertices();
+    size_type size = 0;
+    for(auto a=active.begin(); a!=active.end(); ++a) {
+        auto it = vertices.begin() + *a;
+        if(it->active) {
+            size_type v = it->index;
+            if(it->edge_right >= 0 && it->edge_down >= 0) {
+                size_type tr = sim.edge_connection(it->edge_right, v);
+                size_type bl = sim.edge_connection(it->edge_down, v);
+                out[size++] = {particles.pos[tr], normals[tr], vertex_uv(sim, tr)};
+                out[size++] = {particles.pos[v],  normals[v],  vertex_uv(sim, v)};
+                out[size++] = {particles.pos[bl], normals[bl], vertex_uv(sim, bl)};
+            }
+            if(it->edge_left >= 0 && it->edge_up >= 0) {
+                size_type tr = sim.edge_connection(it->edge_up, v);
+                size_type bl = sim.edge_connection(it->edge_left, v);
+                out[size++] = {particles.pos[tr], normals[tr], vertex_uv(sim, tr)};
+                out[size++] = {particles.pos[bl], normals[bl], vertex_uv(sim, bl)};
+                out[size++] = {particles.pos[v],  normals[v],  vertex_uv(sim, v)};
+            }
+        }
+    }
+    return size;
+}
+
+glm::vec2 physics::vertex_uv(const ClothSim& sim, std::size_t v) {
+    std::size_t n = sim.get_n_vertices();
+    return glm::vec2((float)(v%n)/(n-1), (float)(v/n)/(n-1));
+}
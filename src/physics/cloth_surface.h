@@ -0,0 +1,48 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: cloth_surface.h
+ *  Header file for the surface (normals and triangles) of a ClothSim
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: These are the per-frame surface passes the renderer needs. They only
+ *  read simulation state, so they live next to ClothSim and can be run (and
+ *  timed) without a GL context. surface_vertex is the vertex layout uploaded
+ *  by the renderer (render::vertex).
+ * ---------------------------------------------------------------------------- */
+
+#ifndef CLOTH_SURFACE_H
+#define CLOTH_SURFACE_H
+
+#include "../../lib/glm/vec2.hpp"
+#include "../../lib/glm/vec3.hpp"
+
+#include "cloth_sim.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace physics {
+    // structs
+    struct surface_vertex {
+        glm::vec3 pos;
+        glm::vec3 norm;
+        glm::vec2 uv;
+    };
+
+    // surface sizes
+    // - upper bound of vertices written by compute_triangles()
+    std::size_t max_triangle_vertices(const ClothSim& sim);
+
+    // surface passes
+    // - angle weighted (unnormalized) vertex normals
+    void compute_normals(const ClothSim& sim, std::vector<glm::vec3>& normals);
+    // - 2 triangles per intact quad, returns the number of vertices written
+    std::size_t compute_triangles(const ClothSim& sim, const std::vector<glm::vec3>& normals, surface_vertex* out);
+    glm::vec2 vertex_uv(const ClothSim& sim, std::size_t v);
+}
+
+#endif
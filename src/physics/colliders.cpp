@@ -0,0 +1,518 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: colliders.cpp
+ *  Definition file for the static shape colliders (sphere, capsule, box and
+ *  heightfield) and their batched collision pass
+ * **************************************************************************** */
+
+#include "colliders.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PHYSICS_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+// the vector kernel addresses positions as a flat float array
+static_assert(sizeof(glm::vec3) == 3*sizeof(float), "glm::vec3 must be tightly packed");
+
+// surface points and normals of the penetrating lanes of a block
+struct block_contacts {
+    alignas(32) float sx[physics::COLLIDER_BLOCK];
+    alignas(32) float sy[physics::COLLIDER_BLOCK];
+    alignas(32) float sz[physics::COLLIDER_BLOCK];
+    alignas(32) float nx[physics::COLLIDER_BLOCK];
+    alignas(32) float ny[physics::COLLIDER_BLOCK];
+    alignas(32) float nz[physics::COLLIDER_BLOCK];
+};
+
+static float dot(const glm::vec3& a, const glm::vec3& b) {
+    return a.x*b.x + a.y*b.y + a.z*b.z;
+}
+
+
+
+/* ============================================================================ *
+ * Factories
+ * ============================================================================ */
+// every field a shape does not use is zeroed
+static physics::collider make_collider(physics::ColliderShape shape, float friction) {
+    physics::collider c;
+    c.shape = shape;
+    c.center = glm::vec3(0);
+    c.end = glm::vec3(0);
+    c.radius = 0;
+    c.half_extents = glm::vec3(0);
+    c.rotation = glm::mat3(1.0f);
+    c.columns = 0;
+    c.rows = 0;
+    c.cell_size = 0;
+    c.friction = friction;
+    c.lo = glm::vec3(0);
+    c.hi = glm::vec3(0);
+    return c;
+}
+
+physics::collider physics::make_sphere_collider(const glm::vec3& center, float radius, float friction) {
+    collider c = make_collider(SphereCollider, friction);
+    c.center = center;
+    c.radius = radius;
+    c.lo = center - glm::vec3(radius);
+    c.hi = center + glm::vec3(radius);
+    return c;
+}
+
+physics::collider physics::make_capsule_collider(const glm::vec3& a, const glm::vec3& b, float radius, float friction) {
+    collider c = make_collider(CapsuleCollider, friction);
+    c.center = a;
+    c.end = b;
+    c.radius = radius;
+    c.lo = glm::vec3(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z)) - glm::vec3(radius);
+    c.hi = glm::vec3(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z)) + glm::vec3(radius);
+    return c;
+}
+
+physics::collider physics::make_box_collider(const glm::vec3& center, const glm::vec3& half_extents, const glm::mat3& rotation, float friction) {
+    collider c = make_collider(BoxCollider, friction);
+    c.center = center;
+    c.half_extents = half_extents;
+    c.rotation = rotation;
+    // reach of the rotated box along each world axis
+    glm::vec3 reach(0);
+    for(int k=0; k<3; k++) {
+        const glm::vec3& axis = rotation[k];
+        reach += glm::vec3(std::abs(axis.x), std::abs(axis.y), std::abs(axis.z))*half_extents[k];
+    }
+    c.lo = center - reach;
+    c.hi = center + reach;
+    return c;
+}
+
+physics::collider physics::make_heightfield_collider(const glm::vec3& corner, float cell_size, std::size_t columns, std::size_t rows, const std::vector<float>& heights, float friction) {
+    collider c = make_collider(HeightfieldCollider, friction);
+    c.center = corner;
+    c.columns = columns;
+    c.rows = rows;
+    c.cell_size = cell_size;
+    c.heights = heights;
+    float top = heights.empty() ? 0.0f : *std::max_element(heights.begin(), heights.end());
+    // everything below the surface is inside, however deep
+    c.lo = glm::vec3(corner.x, -std::numeric_limits<float>::infinity(), corner.z);
+    c.hi = glm::vec3(corner.x + cell_size*(columns-1), corner.y + top, corner.z + cell_size*(rows-1));
+    return c;
+}
+
+
+
+/* ============================================================================ *
+ * Collider Set
+ * ============================================================================ */
+physics::collider_set::size_type physics::collider_set::size() const {
+    return colliders.size();
+}
+
+bool physics::collider_set::empty() const {
+    return colliders.empty();
+}
+
+physics::collider_set::size_type physics::collider_set::add(const collider& c) {
+    colliders.push_back(c);
+    return colliders.size() - 1;
+}
+
+void physics::collider_set::clear() {
+    colliders.clear();
+    block_lo.clear();
+    block_hi.clear();
+}
+
+
+
+/* ============================================================================ *
+ * Shape Kernels - Scalar
+ * ============================================================================ */
+static bool sphere_contact(const glm::vec3& center, float r, const glm::vec3& pos, glm::vec3& surface, glm::vec3& normal) {
+    glm::vec3 d = pos - center;
+    float d_length_2 = dot(d, d);
+    if(d_length_2 >= r*r)
+        return false;
+    // a particle at the very center leaves upwards
+    float d_length = std::sqrt(d_length_2);
+    normal = d_length > 0.0f ? d/d_length : glm::vec3(0, 1, 0);
+    surface = center + normal*r;
+    return true;
+}
+
+static bool capsule_contact(const physics::collider& c, float margin, const glm::vec3& pos, glm::vec3& surface, glm::vec3& normal) {
+    glm::vec3 axis = c.end - c.center;
+    float axis_length_2 = dot(axis, axis);
+    float t = axis_length_2 > 0.0f ? dot(pos - c.center, axis)/axis_length_2 : 0.0f;
+    t = std::min(std::max(t, 0.0f), 1.0f);
+    return sphere_contact(c.center + axis*t, c.radius + margin, pos, surface, normal);
+}
+
+static bool box_contact(const physics::collider& c, float margin, const glm::vec3& pos, glm::vec3& surface, glm::vec3& normal) {
+    glm::vec3 d = pos - c.center;
+    glm::vec3 local(dot(c.rotation[0], d), dot(c.rotation[1], d), dot(c.rotation[2], d));
+    glm::vec3 h = c.half_extents + glm::vec3(margin);
+    glm::vec3 pen(h.x - std::abs(local.x), h.y - std::abs(local.y), h.z - std::abs(local.z));
+    if(pen.x <= 0.0f || pen.y <= 0.0f || pen.z <= 0.0f)
+        return false;
+    // out through the nearest face
+    int k = pen.x <= pen.y && pen.x <= pen.z ? 0 : (pen.y <= pen.z ? 1 : 2);
+    float side = local[k] < 0.0f ? -1.0f : 1.0f;
+    local[k] = side*h[k];
+    normal = c.rotation[k]*side;
+    surface = c.center + c.rotation*local;
+    return true;
+}
+
+static bool heightfield_contact(const physics::collider& c, float margin, const glm::vec3& pos, glm::vec3& surface, glm::vec3& normal) {
+    float u = (pos.x - c.center.x)/c.cell_size;
+    float v = (pos.z - c.center.z)/c.cell_size;
+    if(!(u >= 0.0f && v >= 0.0f && u <= c.columns-1 && v <= c.rows-1))
+        return false;
+    std::size_t i = std::min((std::size_t)u, c.columns-2);
+    std::size_t j = std::min((std::size_t)v, c.rows-2);
+    float fu = u - i;
+    float fv = v - j;
+    float h00 = c.heights[j*c.columns + i];
+    float h10 = c.heights[j*c.columns + i+1];
+    float h01 = c.heights[(j+1)*c.columns + i];
+    float h11 = c.heights[(j+1)*c.columns + i+1];
+    float height = c.center.y + margin
+        + (h00*(1.0f - fu) + h10*fu)*(1.0f - fv) + (h01*(1.0f - fu) + h11*fu)*fv;
+    if(pos.y >= height)
+        return false;
+    float dh_du = (h10 - h00)*(1.0f - fv) + (h11 - h01)*fv;
+    float dh_dv = (h01 - h00)*(1.0f - fu) + (h11 - h10)*fu;
+    normal = glm::vec3(-dh_du/c.cell_size, 1.0f, -dh_dv/c.cell_size);
+    normal /= std::sqrt(dot(normal, normal));
+    surface = glm::vec3(pos.x, height, pos.z);
+    return true;
+}
+
+// contacts of lanes [0, count) of block b, returns the penetrating lanes
+static int collide_block_scalar(const physics::particle_set& p, const physics::collider& c, float margin, std::size_t b, std::size_t count, block_contacts& out) {
+    int mask = 0;
+    for(std::size_t l=0; l<count; l++) {
+        const glm::vec3& pos = p.pos[b*physics::COLLIDER_BLOCK + l];
+        glm::vec3 surface;
+        glm::vec3 normal;
+        bool hit;
+        switch(c.shape) {
+            case physics::SphereCollider:
+                hit = sphere_contact(c.center, c.radius + margin, pos, surface, normal);
+                break;
+            case physics::CapsuleCollider:
+                hit = capsule_contact(c, margin, pos, surface, normal);
+                break;
+            case physics::BoxCollider:
+                hit = box_contact(c, margin, pos, surface, normal);
+                break;
+            // case physics::HeightfieldCollider:
+            default:
+                hit = heightfield_contact(c, margin, pos, surface, normal);
+                break;
+        }
+        if(!hit)
+            continue;
+        mask |= 1 << l;
+        out.sx[l] = surface.x;
+        out.sy[l] = surface.y;
+        out.sz[l] = surface.z;
+        out.nx[l] = normal.x;
+        out.ny[l] = normal.y;
+        out.nz[l] = normal.z;
+    }
+    return mask;
+}
+
+
+
+/* ============================================================================ *
+ * Shape Kernels - AVX2
+ * ============================================================================ */
+#ifdef PHYSICS_KERNEL_X86
+// lanes within r of a per-lane center, d = pos - center
+// - helpers taking vectors are inlined, an out of line call would return
+//   to the caller without clearing the upper register halves (vzeroupper)
+__attribute__((target("avx2"), always_inline))
+static inline int sphere_lanes(__m256 cx, __m256 cy, __m256 cz, __m256 dx, __m256 dy, __m256 dz, __m256 r, block_contacts& out) {
+    __m256 d_length_2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+    __m256 hit = _mm256_cmp_ps(d_length_2, _mm256_mul_ps(r, r), _CMP_LT_OQ);
+    int mask = _mm256_movemask_ps(hit);
+    if(mask == 0)
+        return 0;
+    // a particle at the very center leaves upwards
+    __m256 zero = _mm256_setzero_ps();
+    __m256 d_length = _mm256_sqrt_ps(d_length_2);
+    __m256 apart = _mm256_cmp_ps(d_length, zero, _CMP_GT_OQ);
+    __m256 inv = _mm256_and_ps(apart, _mm256_div_ps(_mm256_set1_ps(1.0f), d_length));
+    __m256 nx = _mm256_mul_ps(dx, inv);
+    __m256 ny = _mm256_blendv_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(dy, inv), apart);
+    __m256 nz = _mm256_mul_ps(dz, inv);
+    _mm256_store_ps(out.nx, nx);
+    _mm256_store_ps(out.ny, ny);
+    _mm256_store_ps(out.nz, nz);
+    _mm256_store_ps(out.sx, _mm256_add_ps(cx, _mm256_mul_ps(nx, r)));
+    _mm256_store_ps(out.sy, _mm256_add_ps(cy, _mm256_mul_ps(ny, r)));
+    _mm256_store_ps(out.sz, _mm256_add_ps(cz, _mm256_mul_ps(nz, r)));
+    return mask;
+}
+
+__attribute__((target("avx2"), always_inline))
+static inline __m256 blend3(__m256 a, __m256 b, __m256 c, __m256 pick_a, __m256 pick_b) {
+    return _mm256_blendv_ps(_mm256_blendv_ps(c, b, pick_b), a, pick_a);
+}
+
+// contacts of the 8 lanes of block b, returns the penetrating lanes
+__attribute__((target("avx2")))
+static int collide_block_avx2(const physics::particle_set& p, const physics::collider& c, float margin, std::size_t b, block_contacts& out) {
+    // gather positions (3 floats per particle)
+    const float* pos = &p.pos[b*physics::COLLIDER_BLOCK].x;
+    const __m256i lane_3 = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+    __m256 x = _mm256_i32gather_ps(pos,   lane_3, 4);
+    __m256 y = _mm256_i32gather_ps(pos+1, lane_3, 4);
+    __m256 z = _mm256_i32gather_ps(pos+2, lane_3, 4);
+    __m256 zero = _mm256_setzero_ps();
+    __m256 one = _mm256_set1_ps(1.0f);
+    switch(c.shape) {
+        case physics::SphereCollider: {
+            __m256 cx = _mm256_set1_ps(c.center.x);
+            __m256 cy = _mm256_set1_ps(c.center.y);
+            __m256 cz = _mm256_set1_ps(c.center.z);
+            return sphere_lanes(cx, cy, cz, _mm256_sub_ps(x, cx), _mm256_sub_ps(y, cy), _mm256_sub_ps(z, cz),
+                _mm256_set1_ps(c.radius + margin), out);
+        }
+        case physics::CapsuleCollider: {
+            glm::vec3 axis = c.end - c.center;
+            float axis_length_2 = dot(axis, axis);
+            __m256 ax = _mm256_set1_ps(axis.x);
+            __m256 ay = _mm256_set1_ps(axis.y);
+            __m256 az = _mm256_set1_ps(axis.z);
+            __m256 dx = _mm256_sub_ps(x, _mm256_set1_ps(c.center.x));
+            __m256 dy = _mm256_sub_ps(y, _mm256_set1_ps(c.center.y));
+            __m256 dz = _mm256_sub_ps(z, _mm256_set1_ps(c.center.z));
+            // closest point of the segment
+            __m256 t = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, ax), _mm256_mul_ps(dy, ay)), _mm256_mul_ps(dz, az));
+            t = _mm256_mul_ps(t, _mm256_set1_ps(axis_length_2 > 0.0f ? 1.0f/axis_length_2 : 0.0f));
+            t = _mm256_min_ps(_mm256_max_ps(t, zero), one);
+            __m256 qx = _mm256_add_ps(_mm256_set1_ps(c.center.x), _mm256_mul_ps(ax, t));
+            __m256 qy = _mm256_add_ps(_mm256_set1_ps(c.center.y), _mm256_mul_ps(ay, t));
+            __m256 qz = _mm256_add_ps(_mm256_set1_ps(c.center.z), _mm256_mul_ps(az, t));
+            return sphere_lanes(qx, qy, qz, _mm256_sub_ps(x, qx), _mm256_sub_ps(y, qy), _mm256_sub_ps(z, qz),
+                _mm256_set1_ps(c.radius + margin), out);
+        }
+        case physics::BoxCollider: {
+            const __m256 sign_bit = _mm256_set1_ps(-0.0f);
+            __m256 dx = _mm256_sub_ps(x, _mm256_set1_ps(c.center.x));
+            __m256 dy = _mm256_sub_ps(y, _mm256_set1_ps(c.center.y));
+            __m256 dz = _mm256_sub_ps(z, _mm256_set1_ps(c.center.z));
+            // local coordinates and penetration depth along each axis
+            __m256 local[3];
+            __m256 h[3];
+            __m256 pen[3];
+            for(int k=0; k<3; k++) {
+                const glm::vec3& axis = c.rotation[k];
+                local[k] = _mm256_add_ps(_mm256_add_ps(
+                    _mm256_mul_ps(dx, _mm256_set1_ps(axis.x)),
+                    _mm256_mul_ps(dy, _mm256_set1_ps(axis.y))),
+                    _mm256_mul_ps(dz, _mm256_set1_ps(axis.z)));
+                h[k] = _mm256_set1_ps(c.half_extents[k] + margin);
+                pen[k] = _mm256_sub_ps(h[k], _mm256_andnot_ps(sign_bit, local[k]));
+            }
+            __m256 hit = _mm256_and_ps(_mm256_and_ps(
+                _mm256_cmp_ps(pen[0], zero, _CMP_GT_OQ),
+                _mm256_cmp_ps(pen[1], zero, _CMP_GT_OQ)),
+                _mm256_cmp_ps(pen[2], zero, _CMP_GT_OQ));
+            int mask = _mm256_movemask_ps(hit);
+            if(mask == 0)
+                return 0;
+            // out through the nearest face
+            __m256 pick_0 = _mm256_and_ps(_mm256_cmp_ps(pen[0], pen[1], _CMP_LE_OQ), _mm256_cmp_ps(pen[0], pen[2], _CMP_LE_OQ));
+            __m256 pick_1 = _mm256_andnot_ps(pick_0, _mm256_cmp_ps(pen[1], pen[2], _CMP_LE_OQ));
+            __m256 pick_2 = _mm256_andnot_ps(_mm256_or_ps(pick_0, pick_1), _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+            __m256 pick[3] = {pick_0, pick_1, pick_2};
+            __m256 side[3];
+            for(int k=0; k<3; k++) {
+                // +1 or -1, -1 only for negative coordinates
+                side[k] = _mm256_or_ps(one, _mm256_and_ps(sign_bit, _mm256_cmp_ps(local[k], zero, _CMP_LT_OQ)));
+                local[k] = _mm256_blendv_ps(local[k], _mm256_mul_ps(side[k], h[k]), pick[k]);
+            }
+            __m256 s_nx[3];
+            __m256 s_ny[3];
+            __m256 s_nz[3];
+            __m256 sx = _mm256_set1_ps(c.center.x);
+            __m256 sy = _mm256_set1_ps(c.center.y);
+            __m256 sz = _mm256_set1_ps(c.center.z);
+            for(int k=0; k<3; k++) {
+                const glm::vec3& axis = c.rotation[k];
+                __m256 axis_x = _mm256_set1_ps(axis.x);
+                __m256 axis_y = _mm256_set1_ps(axis.y);
+                __m256 axis_z = _mm256_set1_ps(axis.z);
+                sx = _mm256_add_ps(sx, _mm256_mul_ps(axis_x, local[k]));
+                sy = _mm256_add_ps(sy, _mm256_mul_ps(axis_y, local[k]));
+                sz = _mm256_add_ps(sz, _mm256_mul_ps(axis_z, local[k]));
+                s_nx[k] = _mm256_mul_ps(axis_x, side[k]);
+                s_ny[k] = _mm256_mul_ps(axis_y, side[k]);
+                s_nz[k] = _mm256_mul_ps(axis_z, side[k]);
+            }
+            _mm256_store_ps(out.sx, sx);
+            _mm256_store_ps(out.sy, sy);
+            _mm256_store_ps(out.sz, sz);
+            _mm256_store_ps(out.nx, blend3(s_nx[0], s_nx[1], s_nx[2], pick_0, pick_1));
+            _mm256_store_ps(out.ny, blend3(s_ny[0], s_ny[1], s_ny[2], pick_0, pick_1));
+            _mm256_store_ps(out.nz, blend3(s_nz[0], s_nz[1], s_nz[2], pick_0, pick_1));
+            return mask;
+        }
+        // case physics::HeightfieldCollider:
+        default: {
+            __m256 inv_cell = _mm256_set1_ps(1.0f/c.cell_size);
+            __m256 u = _mm256_mul_ps(_mm256_sub_ps(x, _mm256_set1_ps(c.center.x)), inv_cell);
+            __m256 v = _mm256_mul_ps(_mm256_sub_ps(z, _mm256_set1_ps(c.center.z)), inv_cell);
+            __m256 u_max = _mm256_set1_ps((float)(c.columns-1));
+            __m256 v_max = _mm256_set1_ps((float)(c.rows-1));
+            __m256 inside = _mm256_and_ps(
+                _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ), _mm256_cmp_ps(v, zero, _CMP_GE_OQ)),
+                _mm256_and_ps(_mm256_cmp_ps(u, u_max, _CMP_LE_OQ), _mm256_cmp_ps(v, v_max, _CMP_LE_OQ)));
+            if(_mm256_movemask_ps(inside) == 0)
+                return 0;
+            // clamp so lanes outside still gather valid heights
+            u = _mm256_min_ps(_mm256_max_ps(u, zero), u_max);
+            v = _mm256_min_ps(_mm256_max_ps(v, zero), v_max);
+            __m256i i = _mm256_min_epi32(_mm256_cvttps_epi32(u), _mm256_set1_epi32((int)c.columns-2));
+            __m256i j = _mm256_min_epi32(_mm256_cvttps_epi32(v), _mm256_set1_epi32((int)c.rows-2));
+            __m256 fu = _mm256_sub_ps(u, _mm256_cvtepi32_ps(i));
+            __m256 fv = _mm256_sub_ps(v, _mm256_cvtepi32_ps(j));
+            __m256i columns = _mm256_set1_epi32((int)c.columns);
+            __m256i k00 = _mm256_add_epi32(_mm256_mullo_epi32(j, columns), i);
+            __m256i k01 = _mm256_add_epi32(k00, columns);
+            const float* heights = c.heights.data();
+            __m256 h00 = _mm256_i32gather_ps(heights, k00, 4);
+            __m256 h10 = _mm256_i32gather_ps(heights+1, k00, 4);
+            __m256 h01 = _mm256_i32gather_ps(heights, k01, 4);
+            __m256 h11 = _mm256_i32gather_ps(heights+1, k01, 4);
+            __m256 gu = _mm256_sub_ps(one, fu);
+            __m256 gv = _mm256_sub_ps(one, fv);
+            __m256 height = _mm256_add_ps(_mm256_set1_ps(c.center.y + margin), _mm256_add_ps(
+                _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(h00, gu), _mm256_mul_ps(h10, fu)), gv),
+                _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(h01, gu), _mm256_mul_ps(h11, fu)), fv)));
+            int mask = _mm256_movemask_ps(_mm256_and_ps(inside, _mm256_cmp_ps(y, height, _CMP_LT_OQ)));
+            if(mask == 0)
+                return 0;
+            // normal from the bilinear gradient
+            __m256 dh_du = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(h10, h00), gv), _mm256_mul_ps(_mm256_sub_ps(h11, h01), fv));
+            __m256 dh_dv = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(h01, h00), gu), _mm256_mul_ps(_mm256_sub_ps(h11, h10), fu));
+            __m256 nx = _mm256_sub_ps(zero, _mm256_mul_ps(dh_du, inv_cell));
+            __m256 nz = _mm256_sub_ps(zero, _mm256_mul_ps(dh_dv, inv_cell));
+            __m256 inv_length = _mm256_div_ps(one, _mm256_sqrt_ps(
+                _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, nx), one), _mm256_mul_ps(nz, nz))));
+            _mm256_store_ps(out.nx, _mm256_mul_ps(nx, inv_length));
+            _mm256_store_ps(out.ny, inv_length);
+            _mm256_store_ps(out.nz, _mm256_mul_ps(nz, inv_length));
+            _mm256_store_ps(out.sx, x);
+            _mm256_store_ps(out.sy, height);
+            _mm256_store_ps(out.sz, z);
+            return mask;
+        }
+    }
+}
+#endif
+
+
+
+/* ============================================================================ *
+ * Collision Pass
+ * ============================================================================ */
+void physics::resolve_contact(glm::vec3& pos, const glm::vec3& pos_old, const glm::vec3& surface, const glm::vec3& normal, float friction) {
+    glm::vec3 path = surface - pos_old;
+    glm::vec3 tangent = path - normal*dot(path, normal);
+    pos = surface - tangent*(1.0f - friction);
+}
+
+// bounds of the free lanes of block b, empty (lo > hi) if there are none
+static void bound_block(const physics::particle_set& p, std::size_t b, std::size_t count, int free_lanes, glm::vec3& lo, glm::vec3& hi) {
+    const float infinity = std::numeric_limits<float>::infinity();
+    lo = glm::vec3(infinity);
+    hi = glm::vec3(-infinity);
+    for(std::size_t l=0; l<count; l++) {
+        if(!((free_lanes >> l) & 1))
+            continue;
+        const glm::vec3& pos = p.pos[b*physics::COLLIDER_BLOCK + l];
+        lo = glm::vec3(std::min(lo.x, pos.x), std::min(lo.y, pos.y), std::min(lo.z, pos.z));
+        hi = glm::vec3(std::max(hi.x, pos.x), std::max(hi.y, pos.y), std::max(hi.z, pos.z));
+    }
+}
+
+std::size_t physics::resolve_colliders(particle_set& p, collider_set& s, const aligned_vector<particle_set::mask_word>& frozen, float margin, ThreadPool& pool) {
+    static_assert(particle_set::MASK_WORD_BITS % COLLIDER_BLOCK == 0, "blocks must not straddle mask words");
+    if(s.colliders.empty() || p.empty())
+        return 0;
+    std::size_t num_particles = p.size();
+    std::size_t num_blocks = (num_particles + COLLIDER_BLOCK - 1)/COLLIDER_BLOCK;
+    s.block_lo.resize(num_blocks);
+    s.block_hi.resize(num_blocks);
+    bool avx2 = get_kernel_isa() == AVX2;
+    std::atomic<std::size_t> count_resolved(0);
+    pool.run([&](std::size_t thread, std::size_t num_threads) {
+        std::size_t begin = num_blocks*thread/num_threads;
+        std::size_t end = num_blocks*(thread+1)/num_threads;
+        std::size_t count = 0;
+        // free lanes of each block, from the pinned and frozen masks
+        auto free_lanes = [&](std::size_t b) {
+            std::size_t w = b*COLLIDER_BLOCK/particle_set::MASK_WORD_BITS;
+            particle_set::mask_word stuck = p.pinned[w] | (w < frozen.size() ? frozen[w] : 0);
+            return (int)((~stuck >> (b*COLLIDER_BLOCK % particle_set::MASK_WORD_BITS)) & ((1u << COLLIDER_BLOCK) - 1));
+        };
+        auto block_count = [&](std::size_t b) {
+            return std::min(COLLIDER_BLOCK, num_particles - b*COLLIDER_BLOCK);
+        };
+        for(std::size_t b=begin; b<end; b++)
+            bound_block(p, b, block_count(b), free_lanes(b), s.block_lo[b], s.block_hi[b]);
+        block_contacts contacts;
+        for(auto c=s.colliders.begin(); c!=s.colliders.end(); ++c) {
+            glm::vec3 lo = c->lo - glm::vec3(margin);
+            glm::vec3 hi = c->hi + glm::vec3(margin);
+            for(std::size_t b=begin; b<end; b++) {
+                // early out on the bounds, empty blocks never overlap
+                const glm::vec3& b_lo = s.block_lo[b];
+                const glm::vec3& b_hi = s.block_hi[b];
+                if(b_lo.x > hi.x || b_hi.x < lo.x || b_lo.y > hi.y || b_hi.y < lo.y || b_lo.z > hi.z || b_hi.z < lo.z)
+                    continue;
+                int lanes = free_lanes(b);
+                std::size_t n = block_count(b);
+                int mask;
+#ifdef PHYSICS_KERNEL_X86
+                if(avx2 && n == COLLIDER_BLOCK)
+                    mask = collide_block_avx2(p, *c, margin, b, contacts);
+                else
+#endif
+                    mask = collide_block_scalar(p, *c, margin, b, n, contacts);
+                mask &= lanes;
+                if(mask == 0)
+                    continue;
+                while(mask) {
+                    int l = __builtin_ctz(mask);
+                    mask &= mask - 1;
+                    std::size_t i = b*COLLIDER_BLOCK + l;
+                    resolve_contact(p.pos[i], p.pos_old[i],
+                        glm::vec3(contacts.sx[l], contacts.sy[l], contacts.sz[l]),
+                        glm::vec3(contacts.nx[l], contacts.ny[l], contacts.nz[l]), c->friction);
+                    count++;
+                }
+                // the block moved, so later colliders see its new bounds
+                bound_block(p, b, n, lanes, s.block_lo[b], s.block_hi[b]);
+            }
+        }
+        count_resolved.fetch_add(count, std::memory_order_relaxed);
+    });
+    return count_resolved.load();
+}
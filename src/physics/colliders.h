@@ -0,0 +1,118 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: colliders.h
+ *  Header file for the static shape colliders (sphere, capsule, box and
+ *  heightfield) and their batched collision pass
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: Colliders are plain tagged structs, there is no virtual dispatch per
+ *  particle. A pass first bounds every block of COLLIDER_BLOCK consecutive
+ *  particles, then tests each collider against the blocks: a block whose
+ *  bounds miss the collider's bounds (inflated by the margin) is skipped,
+ *  and the others run the shape's kernel over all of their lanes at once.
+ *  The kernel only finds the penetrating lanes and their surface points and
+ *  normals; those few lanes are then moved to the surface, keeping
+ *  `friction` of their tangential motion over the step (like the floor
+ *  plane). Blocks never share a particle, so the pass is split across the
+ *  pool by block and does not depend on the thread count.
+ *  The AVX2 kernel gathers a block's positions into 8 lanes, the scalar one
+ *  runs the same math lane by lane; SSE2 has no gathers and uses the scalar
+ *  kernel. A heightfield pushes particles straight up to its bilinear
+ *  surface, so it is meant for terrain rather than overhangs.
+ * ---------------------------------------------------------------------------- */
+
+#ifndef COLLIDERS_H
+#define COLLIDERS_H
+
+#include "../../lib/glm/vec3.hpp"
+#include "../../lib/glm/mat3x3.hpp"
+
+#include "particles.h"
+#include "constraint_kernel.h"
+#include "aligned_allocator.h"
+#include "thread_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace physics {
+    // static constants
+    // - particles per bounded block, one AVX2 batch
+    const std::size_t COLLIDER_BLOCK = 8;
+
+    // enums
+    enum ColliderShape {
+        SphereCollider=0,
+        CapsuleCollider,
+        BoxCollider,
+        HeightfieldCollider
+    };
+
+    struct collider {
+        // typedefs
+        typedef std::size_t size_type;
+
+        ColliderShape shape;
+        // - sphere and box center, capsule end, heightfield corner (lowest
+        //   x and z, heights are above its y)
+        glm::vec3 center;
+        glm::vec3 end; // other capsule end
+        float radius; // sphere, capsule
+        // - box, the columns of rotation are its local axes
+        glm::vec3 half_extents;
+        glm::mat3 rotation;
+        // - heightfield, heights[row*columns + column] at
+        //   center + (column, 0, row)*cell_size
+        size_type columns;
+        size_type rows;
+        float cell_size;
+        std::vector<float> heights;
+        // fraction of the tangential motion kept on contact
+        float friction;
+        // bounds of the shape
+        glm::vec3 lo;
+        glm::vec3 hi;
+    };
+
+    // factories
+    // - also compute the bounds
+    collider make_sphere_collider(const glm::vec3& center, float radius, float friction);
+    collider make_capsule_collider(const glm::vec3& a, const glm::vec3& b, float radius, float friction);
+    collider make_box_collider(const glm::vec3& center, const glm::vec3& half_extents, const glm::mat3& rotation, float friction);
+    // - requires columns, rows >= 2 and columns*rows heights
+    collider make_heightfield_collider(const glm::vec3& corner, float cell_size, std::size_t columns, std::size_t rows, const std::vector<float>& heights, float friction);
+
+    struct collider_set {
+        // typedefs
+        typedef std::size_t size_type;
+
+        std::vector<collider> colliders;
+        // per block bounds of the last pass
+        aligned_vector<glm::vec3> block_lo;
+        aligned_vector<glm::vec3> block_hi;
+
+        // container properties
+        size_type size() const;
+        bool empty() const;
+
+        // container manipulation
+        size_type add(const collider& c);
+        void clear();
+    };
+
+    // - moves pos to a surface point, keeping `friction` of its tangential
+    //   motion since pos_old
+    void resolve_contact(glm::vec3& pos, const glm::vec3& pos_old, const glm::vec3& surface, const glm::vec3& normal, float friction);
+    // - pushes every particle not set in `frozen` (same layout as
+    //   particle_set::pinned, may be empty) out of every collider, each
+    //   inflated by margin
+    // - returns the number of contacts that were resolved
+    std::size_t resolve_colliders(particle_set& p, collider_set& s, const aligned_vector<particle_set::mask_word>& frozen, float margin, ThreadPool& pool);
+}
+
+#endif
@@ -0,0 +1,603 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: constraint_kernel.cpp
+ *  Definition file for the distance constraint projection kernels
+ * **************************************************************************** */
+
+#include "constraint_kernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PHYSICS_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+// the vector kernels address positions as a flat float array
+static_assert(sizeof(glm::vec3) == 3*sizeof(float), "glm::vec3 must be tightly packed");
+
+// selected kernel, resolved on first use
+static bool kernel_isa_resolved = false;
+static physics::KernelIsa kernel_isa = physics::Scalar;
+
+// adds a kernel's local error sums to the caller's
+static void add_error(physics::constraint_error* err, float max, float sum_sq) {
+    if(err) {
+        err->max = err->max < max ? max : err->max;
+        err->sum_sq += sum_sq;
+    }
+}
+
+// lists the constraints of the lanes in mask as past their tear length
+static void add_overstretched(physics::constraint_error* err, const physics::constraint_set& c, std::size_t k, int mask) {
+    if(err) {
+        for(int l=0; mask; l++, mask >>= 1) {
+            if(mask & 1)
+                err->overstretched.push_back(c.id[k+l]);
+        }
+    }
+}
+
+
+/* ============================================================================ *
+ * Kernel Selection
+ * ============================================================================ */
+physics::KernelIsa physics::detect_kernel_isa() {
+#ifdef PHYSICS_KERNEL_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+        return AVX2;
+    if(__builtin_cpu_supports("sse2"))
+        return SSE2;
+#endif
+    return Scalar;
+}
+
+physics::KernelIsa physics::get_kernel_isa() {
+    if(!kernel_isa_resolved) {
+        kernel_isa = detect_kernel_isa();
+        kernel_isa_resolved = true;
+    }
+    return kernel_isa;
+}
+
+void physics::set_kernel_isa(KernelIsa isa) {
+    KernelIsa best = detect_kernel_isa();
+    kernel_isa = isa > best ? best : isa;
+    kernel_isa_resolved = true;
+}
+
+
+
+/* ============================================================================ *
+ * Dispatching Entrypoints
+ * ============================================================================ */
+std::size_t physics::solve_distance_constraints(particle_set& p, const constraint_set& c, constraint_error* err) {
+    return solve_distance_constraints(p, c, 0, c.size(), err);
+}
+
+std::size_t physics::solve_distance_constraints(particle_set& p, const constraint_set& c, std::size_t begin, std::size_t end, constraint_error* err) {
+    switch(get_kernel_isa()) {
+        case AVX2:
+            return solve_distance_constraints_avx2(p, c, begin, end, err);
+        case SSE2:
+            return solve_distance_constraints_sse2(p, c, begin, end, err);
+        // case Scalar:
+        default:
+            return solve_distance_constraints_scalar(p, c, begin, end, err);
+    }
+}
+
+std::size_t physics::solve_xpbd_constraints(particle_set& p, const constraint_set& c, xpbd_multipliers& m, constraint_error* err) {
+    return solve_xpbd_constraints(p, c, m, 0, c.size(), err);
+}
+
+std::size_t physics::solve_xpbd_constraints(particle_set& p, const constraint_set& c, xpbd_multipliers& m, std::size_t begin, std::size_t end, constraint_error* err) {
+    switch(get_kernel_isa()) {
+        case AVX2:
+            return solve_xpbd_constraints_avx2(p, c, m, begin, end, err);
+        case SSE2:
+            return solve_xpbd_constraints_sse2(p, c, m, begin, end, err);
+        // case Scalar:
+        default:
+            return solve_xpbd_constraints_scalar(p, c, m, begin, end, err);
+    }
+}
+
+std::size_t physics::solve_constraints(particle_set& p, const constraint_set& c, xpbd_multipliers* m, std::size_t begin, std::size_t end, constraint_error* err) {
+    if(m)
+        return solve_xpbd_constraints(p, c, *m, begin, end, err);
+    return solve_distance_constraints(p, c, begin, end, err);
+}
+
+
+
+/* ============================================================================ *
+ * Kernels - Scalar
+ * ============================================================================ */
+std::size_t physics::solve_distance_constraints_scalar(particle_set& p, const constraint_set& c, std::size_t begin, std::size_t end, constraint_error* err) {
+    std::size_t count_resolved = 0;
+    float err_max = 0;
+    float err_sum_sq = 0;
+    for(std::size_t k=begin; k<end; k++) {
+        std::int32_t a = c.vertex_a[k];
+        std::int32_t b = c.vertex_b[k];
+        glm::vec3& a_pos = p.pos[a];
+        glm::vec3& b_pos = p.pos[b];
+        // calculate squared difference length
+        glm::vec3 v_diff = b_pos - a_pos;
+        float v_diff_length_2 = v_diff.x*v_diff.x + v_diff.y*v_diff.y + v_diff.z*v_diff.z;
+        // only resolve lengths outside of the flex band
+        if(!(v_diff_length_2 < c.lower_sq[k] || v_diff_length_2 > c.upper_sq[k]))
+            continue;
+        float w_a = p.weight(a);
+        float w_b = p.weight(b);
+        float w_sum = w_a + w_b;
+        if(!(w_sum != 0.0f))
+            continue;
+        if(v_diff_length_2 > c.tear_sq[k])
+            add_overstretched(err, c, k, 1);
+        // distance outside of the band, (l^2 - u^2)/(2r^2) ~ (l - u)/r
+        float rest = c.rest_length[k];
+        float e = std::max(v_diff_length_2 - c.upper_sq[k], c.lower_sq[k] - v_diff_length_2) / (2.0f*(rest*rest));
+        err_max = std::max(err_max, e);
+        err_sum_sq += e*e;
+        // move both ends towards the resting length, weighted by inverse mass
+        float v_diff_length = std::sqrt(v_diff_length_2);
+        float s = (v_diff_length - rest) / v_diff_length / w_sum;
+        a_pos += v_diff*(s*w_a);
+        b_pos -= v_diff*(s*w_b);
+        count_resolved++;
+    }
+    add_error(err, err_max, err_sum_sq);
+    return count_resolved;
+}
+
+std::size_t physics::solve_xpbd_constraints_scalar(particle_set& p, const constraint_set& c, xpbd_multipliers& m, std::size_t begin, std::size_t end, constraint_error* err) {
+    const float infinity = std::numeric_limits<float>::infinity();
+    std::size_t count_resolved = 0;
+    float err_max = 0;
+    float err_sum_sq = 0;
+    for(std::size_t k=begin; k<end; k++) {
+        // disabled slots and padding have an infinite flex band
+        if(!(c.upper_sq[k] < infinity))
+            continue;
+        std::int32_t a = c.vertex_a[k];
+        std::int32_t b = c.vertex_b[k];
+        glm::vec3& a_pos = p.pos[a];
+        glm::vec3& b_pos = p.pos[b];
+        glm::vec3 v_diff = b_pos - a_pos;
+        float v_diff_length_2 = v_diff.x*v_diff.x + v_diff.y*v_diff.y + v_diff.z*v_diff.z;
+        float w_a = p.weight(a);
+        float w_b = p.weight(b);
+        float w_sum = w_a + w_b;
+        if(!(w_sum != 0.0f && v_diff_length_2 > 0.0f))
+            continue;
+        if(v_diff_length_2 < c.lower_sq[k] || v_diff_length_2 > c.upper_sq[k]) {
+            count_resolved++;
+            if(v_diff_length_2 > c.tear_sq[k])
+                add_overstretched(err, c, k, 1);
+        }
+        // compliant update of the multiplier, then move along the gradient
+        float v_diff_length = std::sqrt(v_diff_length_2);
+        float& lambda = m.lambda[c.id[k]];
+        float alpha = c.compliance[k]*m.inv_dt_2;
+        float rest = c.rest_length[k];
+        float residual = (rest - v_diff_length) - alpha*lambda;
+        float e = std::abs(residual) / rest;
+        err_max = std::max(err_max, e);
+        err_sum_sq += e*e;
+        float d_lambda = residual / (w_sum + alpha);
+        lambda += d_lambda;
+        float s = d_lambda / v_diff_length;
+        a_pos -= v_diff*(s*w_a);
+        b_pos += v_diff*(s*w_b);
+    }
+    add_error(err, err_max, err_sum_sq);
+    return count_resolved;
+}
+
+
+
+#ifdef PHYSICS_KERNEL_X86
+/* ============================================================================ *
+ * Kernels - Horizontal Reductions
+ * ============================================================================ */
+static float horizontal_max(__m128 v) {
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, v);
+    return std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+}
+static float horizontal_sum(__m128 v) {
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, v);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+__attribute__((target("avx2")))
+static float horizontal_max(__m256 v) {
+    return std::max(horizontal_max(_mm256_castps256_ps128(v)), horizontal_max(_mm256_extractf128_ps(v, 1)));
+}
+__attribute__((target("avx2")))
+static float horizontal_sum(__m256 v) {
+    return horizontal_sum(_mm256_castps256_ps128(v)) + horizontal_sum(_mm256_extractf128_ps(v, 1));
+}
+
+
+
+/* ============================================================================ *
+ * Kernels - SSE2
+ * ============================================================================ */
+std::size_t physics::solve_distance_constraints_sse2(particle_set& p, const constraint_set& c, std::size_t begin, std::size_t end, constraint_error* err) {
+    // sse2 has no gathers, so lanes are loaded one at a time
+    const std::size_t lanes = 4;
+    std::size_t count_resolved = 0;
+    float* pos = &p.pos[0].x;
+    const __m128 two = _mm_set1_ps(2.0f);
+    __m128 err_max = _mm_setzero_ps();
+    __m128 err_sum_sq = _mm_setzero_ps();
+    alignas(16) float out[6][lanes];
+    for(std::size_t k=begin; k<end; k+=lanes) {
+        const std::int32_t* a = &c.vertex_a[k];
+        const std::int32_t* b = &c.vertex_b[k];
+        const float* pa[lanes] = { pos+3*a[0], pos+3*a[1], pos+3*a[2], pos+3*a[3] };
+        const float* pb[lanes] = { pos+3*b[0], pos+3*b[1], pos+3*b[2], pos+3*b[3] };
+        __m128 ax = _mm_setr_ps(pa[0][0], pa[1][0], pa[2][0], pa[3][0]);
+        __m128 ay = _mm_setr_ps(pa[0][1], pa[1][1], pa[2][1], pa[3][1]);
+        __m128 az = _mm_setr_ps(pa[0][2], pa[1][2], pa[2][2], pa[3][2]);
+        __m128 bx = _mm_setr_ps(pb[0][0], pb[1][0], pb[2][0], pb[3][0]);
+        __m128 by = _mm_setr_ps(pb[0][1], pb[1][1], pb[2][1], pb[3][1]);
+        __m128 bz = _mm_setr_ps(pb[0][2], pb[1][2], pb[2][2], pb[3][2]);
+        // squared difference length
+        __m128 dx = _mm_sub_ps(bx, ax);
+        __m128 dy = _mm_sub_ps(by, ay);
+        __m128 dz = _mm_sub_ps(bz, az);
+        __m128 len_2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        // flex band test
+        __m128 lower_sq = _mm_load_ps(&c.lower_sq[k]);
+        __m128 upper_sq = _mm_load_ps(&c.upper_sq[k]);
+        __m128 violated = _mm_or_ps(
+            _mm_cmplt_ps(len_2, lower_sq),
+            _mm_cmpgt_ps(len_2, upper_sq));
+        if(_mm_movemask_ps(violated) == 0)
+            continue;
+        // inverse mass weights
+        __m128 w_a = _mm_setr_ps(p.weight(a[0]), p.weight(a[1]), p.weight(a[2]), p.weight(a[3]));
+        __m128 w_b = _mm_setr_ps(p.weight(b[0]), p.weight(b[1]), p.weight(b[2]), p.weight(b[3]));
+        __m128 w_sum = _mm_add_ps(w_a, w_b);
+        violated = _mm_and_ps(violated, _mm_cmpneq_ps(w_sum, _mm_setzero_ps()));
+        int mask = _mm_movemask_ps(violated);
+        if(mask == 0)
+            continue;
+        // tear test, only for batches that need a correction anyway
+        int torn = mask & _mm_movemask_ps(_mm_cmpgt_ps(len_2, _mm_load_ps(&c.tear_sq[k])));
+        if(torn)
+            add_overstretched(err, c, k, torn);
+        // distance outside of the band
+        __m128 rest = _mm_load_ps(&c.rest_length[k]);
+        __m128 e = _mm_and_ps(violated, _mm_div_ps(
+            _mm_max_ps(_mm_sub_ps(len_2, upper_sq), _mm_sub_ps(lower_sq, len_2)),
+            _mm_mul_ps(two, _mm_mul_ps(rest, rest))));
+        err_max = _mm_max_ps(err_max, e);
+        err_sum_sq = _mm_add_ps(err_sum_sq, _mm_mul_ps(e, e));
+        // corrections
+        __m128 len = _mm_sqrt_ps(len_2);
+        __m128 s = _mm_div_ps(_mm_div_ps(_mm_sub_ps(len, rest), len), w_sum);
+        __m128 s_a = _mm_mul_ps(s, w_a);
+        __m128 s_b = _mm_mul_ps(s, w_b);
+        _mm_store_ps(out[0], _mm_add_ps(ax, _mm_mul_ps(dx, s_a)));
+        _mm_store_ps(out[1], _mm_add_ps(ay, _mm_mul_ps(dy, s_a)));
+        _mm_store_ps(out[2], _mm_add_ps(az, _mm_mul_ps(dz, s_a)));
+        _mm_store_ps(out[3], _mm_sub_ps(bx, _mm_mul_ps(dx, s_b)));
+        _mm_store_ps(out[4], _mm_sub_ps(by, _mm_mul_ps(dy, s_b)));
+        _mm_store_ps(out[5], _mm_sub_ps(bz, _mm_mul_ps(dz, s_b)));
+        // write back only resolved lanes (lanes never share a particle)
+        while(mask) {
+            int l = __builtin_ctz(mask);
+            mask &= mask - 1;
+            p.pos[a[l]] = {out[0][l], out[1][l], out[2][l]};
+            p.pos[b[l]] = {out[3][l], out[4][l], out[5][l]};
+            count_resolved++;
+        }
+    }
+    add_error(err, horizontal_max(err_max), horizontal_sum(err_sum_sq));
+    return count_resolved;
+}
+
+
+std::size_t physics::solve_xpbd_constraints_sse2(particle_set& p, const constraint_set& c, xpbd_multipliers& m, std::size_t begin, std::size_t end, constraint_error* err) {
+    const std::size_t lanes = 4;
+    std::size_t count_resolved = 0;
+    float* pos = &p.pos[0].x;
+    float* lambda = m.lambda.data();
+    const __m128 infinity = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 inv_dt_2 = _mm_set1_ps(m.inv_dt_2);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 err_max = _mm_setzero_ps();
+    __m128 err_sum_sq = _mm_setzero_ps();
+    alignas(16) float out[7][lanes];
+    for(std::size_t k=begin; k<end; k+=lanes) {
+        // disabled slots and padding have an infinite flex band
+        __m128 upper_sq = _mm_load_ps(&c.upper_sq[k]);
+        __m128 enabled = _mm_cmplt_ps(upper_sq, infinity);
+        if(_mm_movemask_ps(enabled) == 0)
+            continue;
+        const std::int32_t* a = &c.vertex_a[k];
+        const std::int32_t* b = &c.vertex_b[k];
+        const std::int32_t* id = &c.id[k];
+        const float* pa[lanes] = { pos+3*a[0], pos+3*a[1], pos+3*a[2], pos+3*a[3] };
+        const float* pb[lanes] = { pos+3*b[0], pos+3*b[1], pos+3*b[2], pos+3*b[3] };
+        __m128 ax = _mm_setr_ps(pa[0][0], pa[1][0], pa[2][0], pa[3][0]);
+        __m128 ay = _mm_setr_ps(pa[0][1], pa[1][1], pa[2][1], pa[3][1]);
+        __m128 az = _mm_setr_ps(pa[0][2], pa[1][2], pa[2][2], pa[3][2]);
+        __m128 bx = _mm_setr_ps(pb[0][0], pb[1][0], pb[2][0], pb[3][0]);
+        __m128 by = _mm_setr_ps(pb[0][1], pb[1][1], pb[2][1], pb[3][1]);
+        __m128 bz = _mm_setr_ps(pb[0][2], pb[1][2], pb[2][2], pb[3][2]);
+        __m128 dx = _mm_sub_ps(bx, ax);
+        __m128 dy = _mm_sub_ps(by, ay);
+        __m128 dz = _mm_sub_ps(bz, az);
+        __m128 len_2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        __m128 w_a = _mm_setr_ps(p.weight(a[0]), p.weight(a[1]), p.weight(a[2]), p.weight(a[3]));
+        __m128 w_b = _mm_setr_ps(p.weight(b[0]), p.weight(b[1]), p.weight(b[2]), p.weight(b[3]));
+        __m128 w_sum = _mm_add_ps(w_a, w_b);
+        enabled = _mm_and_ps(enabled, _mm_and_ps(
+            _mm_cmpneq_ps(w_sum, zero), _mm_cmpgt_ps(len_2, zero)));
+        int mask = _mm_movemask_ps(enabled);
+        if(mask == 0)
+            continue;
+        __m128 violated = _mm_or_ps(
+            _mm_cmplt_ps(len_2, _mm_load_ps(&c.lower_sq[k])),
+            _mm_cmpgt_ps(len_2, upper_sq));
+        int resolved = mask & _mm_movemask_ps(violated);
+        count_resolved += __builtin_popcount(resolved);
+        if(resolved) {
+            int torn = resolved & _mm_movemask_ps(_mm_cmpgt_ps(len_2, _mm_load_ps(&c.tear_sq[k])));
+            if(torn)
+                add_overstretched(err, c, k, torn);
+        }
+        // compliant multiplier update
+        __m128 len = _mm_sqrt_ps(len_2);
+        __m128 l = _mm_setr_ps(lambda[id[0]], lambda[id[1]], lambda[id[2]], lambda[id[3]]);
+        __m128 alpha = _mm_mul_ps(_mm_load_ps(&c.compliance[k]), inv_dt_2);
+        __m128 rest = _mm_load_ps(&c.rest_length[k]);
+        __m128 residual = _mm_sub_ps(_mm_sub_ps(rest, len), _mm_mul_ps(alpha, l));
+        __m128 e = _mm_and_ps(enabled, _mm_div_ps(_mm_andnot_ps(sign, residual), rest));
+        err_max = _mm_max_ps(err_max, e);
+        err_sum_sq = _mm_add_ps(err_sum_sq, _mm_mul_ps(e, e));
+        __m128 d_lambda = _mm_div_ps(residual, _mm_add_ps(w_sum, alpha));
+        __m128 s = _mm_div_ps(d_lambda, len);
+        __m128 s_a = _mm_mul_ps(s, w_a);
+        __m128 s_b = _mm_mul_ps(s, w_b);
+        _mm_store_ps(out[0], _mm_sub_ps(ax, _mm_mul_ps(dx, s_a)));
+        _mm_store_ps(out[1], _mm_sub_ps(ay, _mm_mul_ps(dy, s_a)));
+        _mm_store_ps(out[2], _mm_sub_ps(az, _mm_mul_ps(dz, s_a)));
+        _mm_store_ps(out[3], _mm_add_ps(bx, _mm_mul_ps(dx, s_b)));
+        _mm_store_ps(out[4], _mm_add_ps(by, _mm_mul_ps(dy, s_b)));
+        _mm_store_ps(out[5], _mm_add_ps(bz, _mm_mul_ps(dz, s_b)));
+        _mm_store_ps(out[6], _mm_add_ps(l, d_lambda));
+        while(mask) {
+            int i = __builtin_ctz(mask);
+            mask &= mask - 1;
+            p.pos[a[i]] = {out[0][i], out[1][i], out[2][i]};
+            p.pos[b[i]] = {out[3][i], out[4][i], out[5][i]};
+            lambda[id[i]] = out[6][i];
+        }
+    }
+    add_error(err, horizontal_max(err_max), horizontal_sum(err_sum_sq));
+    return count_resolved;
+}
+
+
+
+/* ============================================================================ *
+ * Kernels - AVX2
+ * ============================================================================ */
+__attribute__((target("avx2")))
+std::size_t physics::solve_distance_constraints_avx2(particle_set& p, const constraint_set& c, std::size_t begin, std::size_t end, constraint_error* err) {
+    const std::size_t lanes = 8;
+    std::size_t count_resolved = 0;
+    const float* pos = &p.pos[0].x;
+    const float* inv_mass = p.inv_mass.data();
+    const int* pinned = (const int*)p.pinned.data();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i bit_mask = _mm256_set1_epi32(particle_set::MASK_WORD_BITS - 1);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    __m256 err_max = _mm256_setzero_ps();
+    __m256 err_sum_sq = _mm256_setzero_ps();
+    alignas(32) float out[6][lanes];
+    for(std::size_t k=begin; k<end; k+=lanes) {
+        __m256i a = _mm256_load_si256((const __m256i*)&c.vertex_a[k]);
+        __m256i b = _mm256_load_si256((const __m256i*)&c.vertex_b[k]);
+        // gather positions (3 floats per particle)
+        __m256i a_3 = _mm256_add_epi32(_mm256_slli_epi32(a, 1), a);
+        __m256i b_3 = _mm256_add_epi32(_mm256_slli_epi32(b, 1), b);
+        __m256 ax = _mm256_i32gather_ps(pos,   a_3, 4);
+        __m256 ay = _mm256_i32gather_ps(pos+1, a_3, 4);
+        __m256 az = _mm256_i32gather_ps(pos+2, a_3, 4);
+        __m256 bx = _mm256_i32gather_ps(pos,   b_3, 4);
+        __m256 by = _mm256_i32gather_ps(pos+1, b_3, 4);
+        __m256 bz = _mm256_i32gather_ps(pos+2, b_3, 4);
+        // squared difference length
+        __m256 dx = _mm256_sub_ps(bx, ax);
+        __m256 dy = _mm256_sub_ps(by, ay);
+        __m256 dz = _mm256_sub_ps(bz, az);
+        __m256 len_2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+        // flex band test
+        __m256 lower_sq = _mm256_load_ps(&c.lower_sq[k]);
+        __m256 upper_sq = _mm256_load_ps(&c.upper_sq[k]);
+        __m256 violated = _mm256_or_ps(
+            _mm256_cmp_ps(len_2, lower_sq, _CMP_LT_OQ),
+            _mm256_cmp_ps(len_2, upper_sq, _CMP_GT_OQ));
+        if(_mm256_movemask_ps(violated) == 0)
+            continue;
+        // inverse mass weights, zeroed for pinned particles
+        __m256i a_bit = _mm256_and_si256(one, _mm256_srlv_epi32(
+            _mm256_i32gather_epi32(pinned, _mm256_srli_epi32(a, 5), 4), _mm256_and_si256(a, bit_mask)));
+        __m256i b_bit = _mm256_and_si256(one, _mm256_srlv_epi32(
+            _mm256_i32gather_epi32(pinned, _mm256_srli_epi32(b, 5), 4), _mm256_and_si256(b, bit_mask)));
+        __m256 w_a = _mm256_andnot_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a_bit, one)),
+            _mm256_i32gather_ps(inv_mass, a, 4));
+        __m256 w_b = _mm256_andnot_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(b_bit, one)),
+            _mm256_i32gather_ps(inv_mass, b, 4));
+        __m256 w_sum = _mm256_add_ps(w_a, w_b);
+        violated = _mm256_and_ps(violated, _mm256_cmp_ps(w_sum, _mm256_setzero_ps(), _CMP_NEQ_OQ));
+        int mask = _mm256_movemask_ps(violated);
+        if(mask == 0)
+            continue;
+        // tear test, only for batches that need a correction anyway
+        int torn = mask & _mm256_movemask_ps(_mm256_cmp_ps(len_2, _mm256_load_ps(&c.tear_sq[k]), _CMP_GT_OQ));
+        if(torn)
+            add_overstretched(err, c, k, torn);
+        // distance outside of the band
+        __m256 rest = _mm256_load_ps(&c.rest_length[k]);
+        __m256 e = _mm256_and_ps(violated, _mm256_div_ps(
+            _mm256_max_ps(_mm256_sub_ps(len_2, upper_sq), _mm256_sub_ps(lower_sq, len_2)),
+            _mm256_mul_ps(two, _mm256_mul_ps(rest, rest))));
+        err_max = _mm256_max_ps(err_max, e);
+        err_sum_sq = _mm256_add_ps(err_sum_sq, _mm256_mul_ps(e, e));
+        // corrections
+        __m256 len = _mm256_sqrt_ps(len_2);
+        __m256 s = _mm256_div_ps(_mm256_div_ps(_mm256_sub_ps(len, rest), len), w_sum);
+        __m256 s_a = _mm256_mul_ps(s, w_a);
+        __m256 s_b = _mm256_mul_ps(s, w_b);
+        _mm256_store_ps(out[0], _mm256_add_ps(ax, _mm256_mul_ps(dx, s_a)));
+        _mm256_store_ps(out[1], _mm256_add_ps(ay, _mm256_mul_ps(dy, s_a)));
+        _mm256_store_ps(out[2], _mm256_add_ps(az, _mm256_mul_ps(dz, s_a)));
+        _mm256_store_ps(out[3], _mm256_sub_ps(bx, _mm256_mul_ps(dx, s_b)));
+        _mm256_store_ps(out[4], _mm256_sub_ps(by, _mm256_mul_ps(dy, s_b)));
+        _mm256_store_ps(out[5], _mm256_sub_ps(bz, _mm256_mul_ps(dz, s_b)));
+        // write back only resolved lanes (lanes never share a particle)
+        const std::int32_t* a_idx = &c.vertex_a[k];
+        const std::int32_t* b_idx = &c.vertex_b[k];
+        while(mask) {
+            int l = __builtin_ctz(mask);
+            mask &= mask - 1;
+            p.pos[a_idx[l]] = {out[0][l], out[1][l], out[2][l]};
+            p.pos[b_idx[l]] = {out[3][l], out[4][l], out[5][l]};
+            count_resolved++;
+        }
+    }
+    add_error(err, horizontal_max(err_max), horizontal_sum(err_sum_sq));
+    return count_resolved;
+}
+__attribute__((target("avx2")))
+std::size_t physics::solve_xpbd_constraints_avx2(particle_set& p, const constraint_set& c, xpbd_multipliers& m, std::size_t begin, std::size_t end, constraint_error* err) {
+    const std::size_t lanes = 8;
+    std::size_t count_resolved = 0;
+    const float* pos = &p.pos[0].x;
+    float* lambda = m.lambda.data();
+    const float* inv_mass = p.inv_mass.data();
+    const int* pinned = (const int*)p.pinned.data();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i bit_mask = _mm256_set1_epi32(particle_set::MASK_WORD_BITS - 1);
+    const __m256 infinity = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 inv_dt_2 = _mm256_set1_ps(m.inv_dt_2);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 err_max = _mm256_setzero_ps();
+    __m256 err_sum_sq = _mm256_setzero_ps();
+    alignas(32) float out[7][lanes];
+    for(std::size_t k=begin; k<end; k+=lanes) {
+        // disabled slots and padding have an infinite flex band
+        __m256 upper_sq = _mm256_load_ps(&c.upper_sq[k]);
+        __m256 enabled = _mm256_cmp_ps(upper_sq, infinity, _CMP_LT_OQ);
+        if(_mm256_movemask_ps(enabled) == 0)
+            continue;
+        __m256i a = _mm256_load_si256((const __m256i*)&c.vertex_a[k]);
+        __m256i b = _mm256_load_si256((const __m256i*)&c.vertex_b[k]);
+        __m256i a_3 = _mm256_add_epi32(_mm256_slli_epi32(a, 1), a);
+        __m256i b_3 = _mm256_add_epi32(_mm256_slli_epi32(b, 1), b);
+        __m256 ax = _mm256_i32gather_ps(pos,   a_3, 4);
+        __m256 ay = _mm256_i32gather_ps(pos+1, a_3, 4);
+        __m256 az = _mm256_i32gather_ps(pos+2, a_3, 4);
+        __m256 bx = _mm256_i32gather_ps(pos,   b_3, 4);
+        __m256 by = _mm256_i32gather_ps(pos+1, b_3, 4);
+        __m256 bz = _mm256_i32gather_ps(pos+2, b_3, 4);
+        __m256 dx = _mm256_sub_ps(bx, ax);
+        __m256 dy = _mm256_sub_ps(by, ay);
+        __m256 dz = _mm256_sub_ps(bz, az);
+        __m256 len_2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+        // inverse mass weights, zeroed for pinned particles
+        __m256i a_bit = _mm256_and_si256(one, _mm256_srlv_epi32(
+            _mm256_i32gather_epi32(pinned, _mm256_srli_epi32(a, 5), 4), _mm256_and_si256(a, bit_mask)));
+        __m256i b_bit = _mm256_and_si256(one, _mm256_srlv_epi32(
+            _mm256_i32gather_epi32(pinned, _mm256_srli_epi32(b, 5), 4), _mm256_and_si256(b, bit_mask)));
+        __m256 w_a = _mm256_andnot_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a_bit, one)),
+            _mm256_i32gather_ps(inv_mass, a, 4));
+        __m256 w_b = _mm256_andnot_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(b_bit, one)),
+            _mm256_i32gather_ps(inv_mass, b, 4));
+        __m256 w_sum = _mm256_add_ps(w_a, w_b);
+        enabled = _mm256_and_ps(enabled, _mm256_and_ps(
+            _mm256_cmp_ps(w_sum, zero, _CMP_NEQ_OQ), _mm256_cmp_ps(len_2, zero, _CMP_GT_OQ)));
+        int mask = _mm256_movemask_ps(enabled);
+        if(mask == 0)
+            continue;
+        __m256 violated = _mm256_or_ps(
+            _mm256_cmp_ps(len_2, _mm256_load_ps(&c.lower_sq[k]), _CMP_LT_OQ),
+            _mm256_cmp_ps(len_2, upper_sq, _CMP_GT_OQ));
+        int resolved = mask & _mm256_movemask_ps(violated);
+        count_resolved += __builtin_popcount(resolved);
+        if(resolved) {
+            int torn = resolved & _mm256_movemask_ps(_mm256_cmp_ps(len_2, _mm256_load_ps(&c.tear_sq[k]), _CMP_GT_OQ));
+            if(torn)
+                add_overstretched(err, c, k, torn);
+        }
+        // compliant multiplier update
+        __m256i id = _mm256_load_si256((const __m256i*)&c.id[k]);
+        __m256 len = _mm256_sqrt_ps(len_2);
+        __m256 l = _mm256_i32gather_ps(lambda, id, 4);
+        __m256 alpha = _mm256_mul_ps(_mm256_load_ps(&c.compliance[k]), inv_dt_2);
+        __m256 rest = _mm256_load_ps(&c.rest_length[k]);
+        __m256 residual = _mm256_sub_ps(_mm256_sub_ps(rest, len), _mm256_mul_ps(alpha, l));
+        __m256 e = _mm256_and_ps(enabled, _mm256_div_ps(_mm256_andnot_ps(sign, residual), rest));
+        err_max = _mm256_max_ps(err_max, e);
+        err_sum_sq = _mm256_add_ps(err_sum_sq, _mm256_mul_ps(e, e));
+        __m256 d_lambda = _mm256_div_ps(residual, _mm256_add_ps(w_sum, alpha));
+        __m256 s = _mm256_div_ps(d_lambda, len);
+        __m256 s_a = _mm256_mul_ps(s, w_a);
+        __m256 s_b = _mm256_mul_ps(s, w_b);
+        _mm256_store_ps(out[0], _mm256_sub_ps(ax, _mm256_mul_ps(dx, s_a)));
+        _mm256_store_ps(out[1], _mm256_sub_ps(ay, _mm256_mul_ps(dy, s_a)));
+        _mm256_store_ps(out[2], _mm256_sub_ps(az, _mm256_mul_ps(dz, s_a)));
+        _mm256_store_ps(out[3], _mm256_add_ps(bx, _mm256_mul_ps(dx, s_b)));
+        _mm256_store_ps(out[4], _mm256_add_ps(by, _mm256_mul_ps(dy, s_b)));
+        _mm256_store_ps(out[5], _mm256_add_ps(bz, _mm256_mul_ps(dz, s_b)));
+        _mm256_store_ps(out[6], _mm256_add_ps(l, d_lambda));
+        // write back enabled lanes (lanes never share a particle or an id)
+        const std::int32_t* a_idx = &c.vertex_a[k];
+        const std::int32_t* b_idx = &c.vertex_b[k];
+        const std::int32_t* id_idx = &c.id[k];
+        while(mask) {
+            int i = __builtin_ctz(mask);
+            mask &= mask - 1;
+            p.pos[a_idx[i]] = {out[0][i], out[1][i], out[2][i]};
+            p.pos[b_idx[i]] = {out[3][i], out[4][i], out[5][i]};
+            lambda[id_idx[i]] = out[6][i];
+        }
+    }
+    add_error(err, horizontal_max(err_max), horizontal_sum(err_sum_sq));
+    return count_resolved;
+}
+
+#else
+/* ============================================================================ *
+ * Kernels - Non-x86 Fallbacks
+ * ============================================================================ */
+std::size_t physics::solve_distance_constraints_sse2(particle_set& p, const constraint_set& c, std::size_t begin, std::size_t end, constraint_error* err) {
+    return solve_distance_constraints_scalar(p, c, begin, end, err);
+}
+std::size_t physics::solve_distance_constraints_avx2(particle_set& p, const constraint_set& c, std::size_t begin, std::size_t end, constraint_error* err) {
+    return solve_distance_constraints_scalar(p, c, begin, end, err);
+}
+std::size_t physics::solve_xpbd_constraints_sse2(particle_set& p, const constraint_set& c, xpbd_multipliers& m, std::size_t begin, std::size_t end, constraint_error* err) {
+    return solve_xpbd_constraints_scalar(p, c, m, begin, end, err);
+}
+std::size_t physics::solve_xpbd_constraints_avx2(particle_set& p, const constraint_set& c, xpbd_multipliers& m, std::size_t begin, std::size_t end, constraint_error* err) {
+    return solve_xpbd_constraints_scalar(p, c, m, begin, end, err);
+}
+#endif
@@ -0,0 +1,104 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: constraint_kernel.h
+ *  Header file for the distance constraint projection kernels
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: Every kernel projects the slots of a constraint_set in order, one
+ *  batch of BATCH_WIDTH at a time, and weights each correction by the
+ *  particles' inverse masses (pinned particles weigh 0). The scalar, SSE2 and
+ *  AVX2 kernels perform the same IEEE operations in the same order, so they
+ *  agree bit for bit unless the compiler contracts the scalar path into FMAs.
+ *  The documented tolerance between any two kernels is 1e-6 * cloth scale
+ *  per particle and step.
+ *  The xpbd kernels project every enabled slot with the compliant update
+ *      dlambda = (-C - alpha~*lambda) / (w_a + w_b + alpha~),
+ *  alpha~ = compliance/dt^2, so stiffness no longer depends on the number of
+ *  iterations. They share the batch layout and the bit-for-bit guarantee.
+ *  Every kernel can also report the error of the constraints it projected,
+ *  relative to their rest lengths: the distance outside of the flex band
+ *  (FlexBand) or the compliant residual |C + alpha~*lambda| (xpbd). The max
+ *  is exact in any order; sum_sq depends on the kernel and the thread split.
+ *  Along with the error, a kernel lists the ids of the constraints it found
+ *  longer than their tear length. The test only runs on batches that already
+ *  need a correction, so it costs nothing while the cloth is within its
+ *  flex band.
+ * ---------------------------------------------------------------------------- */
+
+#ifndef CONSTRAINT_KERNEL_H
+#define CONSTRAINT_KERNEL_H
+
+#include "particles.h"
+#include "constraints.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace physics {
+    // enums
+    enum KernelIsa {
+        Scalar=0,
+        SSE2,
+        AVX2
+    };
+
+    // structs
+    // - error of the constraints projected by one sweep
+    struct constraint_error {
+        float max;
+        double sum_sq;
+        std::vector<std::int32_t> overstretched; // ids past their tear length
+
+        void clear();
+        void merge(const constraint_error& o);
+    };
+
+    // kernel selection
+    // - the best kernel supported by the running cpu
+    KernelIsa detect_kernel_isa();
+    KernelIsa get_kernel_isa();
+    // - requests above detect_kernel_isa() are clamped down to it
+    void set_kernel_isa(KernelIsa isa);
+
+    // dispatching entrypoints
+    // - begin and end must be multiples of BATCH_WIDTH
+    // - returns the number of constraints that were resolved
+    std::size_t solve_distance_constraints(particle_set& p, const constraint_set& c, constraint_error* err=nullptr);
+    std::size_t solve_distance_constraints(particle_set& p, const constraint_set& c, std::size_t begin, std::size_t end, constraint_error* err=nullptr);
+
+    // kernels
+    std::size_t solve_distance_constraints_scalar(particle_set& p, const constraint_set& c, std::size_t begin, std::size_t end, constraint_error* err=nullptr);
+    std::size_t solve_distance_constraints_sse2(particle_set& p, const constraint_set& c, std::size_t begin, std::size_t end, constraint_error* err=nullptr);
+    std::size_t solve_distance_constraints_avx2(particle_set& p, const constraint_set& c, std::size_t begin, std::size_t end, constraint_error* err=nullptr);
+
+    // dispatching entrypoints (xpbd)
+    // - returns the number of constraints outside of their flex band
+    std::size_t solve_xpbd_constraints(particle_set& p, const constraint_set& c, xpbd_multipliers& m, constraint_error* err=nullptr);
+    std::size_t solve_xpbd_constraints(particle_set& p, const constraint_set& c, xpbd_multipliers& m, std::size_t begin, std::size_t end, constraint_error* err=nullptr);
+    // - projects with the xpbd kernels if m is given, else the flex band ones
+    std::size_t solve_constraints(particle_set& p, const constraint_set& c, xpbd_multipliers* m, std::size_t begin, std::size_t end, constraint_error* err=nullptr);
+
+    // kernels (xpbd)
+    std::size_t solve_xpbd_constraints_scalar(particle_set& p, const constraint_set& c, xpbd_multipliers& m, std::size_t begin, std::size_t end, constraint_error* err=nullptr);
+    std::size_t solve_xpbd_constraints_sse2(particle_set& p, const constraint_set& c, xpbd_multipliers& m, std::size_t begin, std::size_t end, constraint_error* err=nullptr);
+    std::size_t solve_xpbd_constraints_avx2(particle_set& p, const constraint_set& c, xpbd_multipliers& m, std::size_t begin, std::size_t end, constraint_error* err=nullptr);
+
+    // inline error accumulation
+    inline void constraint_error::clear() {
+        max = 0;
+        sum_sq = 0;
+        overstretched.clear();
+    }
+    inline void constraint_error::merge(const constraint_error& o) {
+        max = max < o.max ? o.max : max;
+        sum_sq += o.sum_sq;
+        overstretched.insert(overstretched.end(), o.overstretched.begin(), o.overstretched.end());
+    }
+}
+
+#endif
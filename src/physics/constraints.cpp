@@ -0,0 +1,228 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: constraints.cpp
+ *  Definition file for the solver-side distance constraint storage
+ * **************************************************************************** */
+
+#include "constraints.h"
+
+#include <algorithm>
+#include <limits>
+
+/* ============================================================================ *
+ * Static Constant Definitions
+ * ============================================================================ */
+const physics::constraint_set::size_type
+physics::constraint_set::NO_SLOT
+    = std::numeric_limits<size_type>::max();
+
+
+
+/* ============================================================================ *
+ * Container Manipulation
+ * ============================================================================ */
+void physics::constraint_set::clear() {
+    vertex_a.clear();
+    vertex_b.clear();
+    id.clear();
+    rest_length.clear();
+    compliance.clear();
+    lower_sq.clear();
+    upper_sq.clear();
+    tear_sq.clear();
+    slot.clear();
+    group_begin.clear();
+}
+
+void physics::constraint_set::build(const std::vector<distance_constraint>& constraints, size_type num_particles) {
+    clear();
+    _reserve(constraints.size() + BATCH_WIDTH);
+    slot.assign(constraints.size(), NO_SLOT);
+
+    std::vector<size_type> ids(constraints.size());
+    for(size_type i=0; i<constraints.size(); i++)
+        ids[i] = i;
+    std::vector<size_type> batch_stamp(num_particles, NO_SLOT);
+    _pack_batches(constraints, ids, batch_stamp);
+}
+
+void physics::constraint_set::build_colored(const std::vector<distance_constraint>& constraints, unsigned num_colors) {
+    clear();
+    _reserve(constraints.size() + num_colors*BATCH_WIDTH);
+    slot.assign(constraints.size(), NO_SLOT);
+
+    std::vector<unsigned> colors(constraints.size());
+    for(size_type i=0; i<constraints.size(); i++)
+        colors[i] = constraints[i].color;
+    std::vector<size_type> order;
+    std::vector<size_type> count;
+    _sort_by_group(colors, num_colors, order, count);
+
+    // emit each color padded to a whole number of batches
+    // - a color never shares a particle, so no packing is needed
+    auto next = order.begin();
+    for(unsigned k=0; k<num_colors; k++) {
+        group_begin.push_back(size());
+        for(auto end=next+count[k]; next!=end; ++next) {
+            if(constraints[*next].disabled)
+                continue;
+            slot[*next] = size();
+            _push_slot(constraints[*next], *next);
+        }
+        while(size() % BATCH_WIDTH != 0)
+            _push_padding();
+    }
+    group_begin.push_back(size());
+}
+
+void physics::constraint_set::build_tiled(const std::vector<distance_constraint>& constraints, size_type grid_width, size_type tile_side, size_type tile_offset) {
+    clear();
+    size_type num_particles = grid_width*grid_width;
+    size_type tiles_per_side = (grid_width + tile_offset + tile_side - 1)/tile_side;
+    size_type num_tiles = tiles_per_side*tiles_per_side;
+    _reserve(constraints.size() + num_tiles*BATCH_WIDTH);
+    slot.assign(constraints.size(), NO_SLOT);
+
+    // a constraint belongs to the tile of its higher (row-major) particle,
+    // the particle it was created from; its other end may lie in the halo
+    // of the tile above or to the left
+    std::vector<unsigned> tiles(constraints.size());
+    for(size_type i=0; i<constraints.size(); i++) {
+        size_type v = std::max(constraints[i].a, constraints[i].b);
+        size_type tr = (v/grid_width + tile_offset)/tile_side;
+        size_type tc = (v%grid_width + tile_offset)/tile_side;
+        tiles[i] = tr*tiles_per_side + tc;
+    }
+    std::vector<size_type> order;
+    std::vector<size_type> count;
+    _sort_by_group(tiles, num_tiles, order, count);
+
+    // pack each tile on its own so its batches stay contiguous
+    std::vector<size_type> batch_stamp(num_particles, NO_SLOT);
+    std::vector<size_type> ids;
+    auto next = order.begin();
+    for(size_type t=0; t<num_tiles; t++) {
+        group_begin.push_back(size());
+        ids.assign(next, next+count[t]);
+        next += count[t];
+        _pack_batches(constraints, ids, batch_stamp);
+    }
+    group_begin.push_back(size());
+}
+
+void physics::constraint_set::disable(size_type id) {
+    if(id >= slot.size())
+        return;
+    size_type s = slot[id];
+    if(s == NO_SLOT)
+        return;
+    // an empty band that no length can fall outside of
+    // - the infinite upper bound also marks the slot disabled for xpbd
+    lower_sq[s] = -1.0f;
+    upper_sq[s] = std::numeric_limits<float>::infinity();
+    tear_sq[s] = std::numeric_limits<float>::infinity();
+    slot[id] = NO_SLOT;
+}
+
+
+
+/* ============================================================================ *
+ * Private Functions
+ * ============================================================================ */
+void physics::constraint_set::_reserve(size_type n) {
+    vertex_a.reserve(n);
+    vertex_b.reserve(n);
+    id.reserve(n);
+    rest_length.reserve(n);
+    compliance.reserve(n);
+    lower_sq.reserve(n);
+    upper_sq.reserve(n);
+    tear_sq.reserve(n);
+}
+
+void physics::constraint_set::_sort_by_group(const std::vector<unsigned>& group, unsigned num_groups, std::vector<size_type>& order, std::vector<size_type>& count) {
+    // counting sort, keeping the build order within a group
+    count.assign(num_groups, 0);
+    for(auto it=group.begin(); it!=group.end(); ++it)
+        count[*it]++;
+    std::vector<size_type> start(num_groups, 0);
+    for(unsigned k=1; k<num_groups; k++)
+        start[k] = start[k-1] + count[k-1];
+    order.resize(group.size());
+    for(size_type i=0; i<group.size(); i++)
+        order[start[group[i]]++] = i;
+}
+
+void physics::constraint_set::_pack_batches(const std::vector<distance_constraint>& constraints, std::vector<size_type>& ids, std::vector<size_type>& batch_stamp) {
+    // disabled constraints get no slot
+    ids.erase(std::remove_if(ids.begin(), ids.end(),
+        [&](size_type i) { return constraints[i].disabled; }), ids.end());
+    // greedily pack constraints into batches that touch each particle once
+    // - constraints that collide with the open batch are deferred to the next
+    //   pass, so the original (Gauss-Seidel) order is kept as far as possible
+    std::vector<size_type> deferred;
+    while(!ids.empty()) {
+        // the last pass placed nothing (every remaining constraint collided
+        // with the open batch), close it
+        if(deferred.size() == ids.size()) {
+            while(size() % BATCH_WIDTH != 0)
+                _push_padding();
+        }
+        deferred.clear();
+        for(auto it=ids.begin(); it!=ids.end(); ++it) {
+            const distance_constraint& c = constraints[*it];
+            size_type batch = size()/BATCH_WIDTH;
+            if(batch_stamp[c.a] == batch || batch_stamp[c.b] == batch) {
+                deferred.push_back(*it);
+                continue;
+            }
+            batch_stamp[c.a] = batch;
+            batch_stamp[c.b] = batch;
+            slot[*it] = size();
+            _push_slot(c, *it);
+        }
+        ids.swap(deferred);
+    }
+    // pad the last batch
+    while(size() % BATCH_WIDTH != 0)
+        _push_padding();
+}
+
+void physics::constraint_set::_push_slot(const distance_constraint& c, size_type c_id) {
+    float lower = c.rest_length*(1.0f - c.flex_coeff);
+    float upper = c.rest_length*(1.0f + c.flex_coeff);
+    vertex_a.push_back((std::int32_t)c.a);
+    vertex_b.push_back((std::int32_t)c.b);
+    id.push_back((std::int32_t)c_id);
+    rest_length.push_back(c.rest_length);
+    compliance.push_back(c.compliance);
+    lower_sq.push_back(lower*lower);
+    upper_sq.push_back(upper*upper);
+    float tear = c.rest_length*c.tear_ratio;
+    tear_sq.push_back(c.tear_ratio > 0 ? tear*tear : std::numeric_limits<float>::infinity());
+}
+
+void physics::constraint_set::_push_padding() {
+    // padding points at particle 0 and is never resolved
+    vertex_a.push_back(0);
+    vertex_b.push_back(0);
+    id.push_back(0);
+    rest_length.push_back(0);
+    compliance.push_back(0);
+    lower_sq.push_back(-1.0f);
+    upper_sq.push_back(std::numeric_limits<float>::infinity());
+    tear_sq.push_back(std::numeric_limits<float>::infinity());
+}
+
+
+
+/* ============================================================================ *
+ * XPBD Multipliers
+ * ============================================================================ */
+void physics::xpbd_multipliers::reset(size_type num_constraints, float time_step) {
+    lambda.assign(num_constraints, 0.0f);
+    inv_dt_2 = 1.0f/(time_step*time_step);
+}
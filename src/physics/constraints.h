@@ -0,0 +1,126 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: constraints.h
+ *  Header file for the solver-side distance constraint storage
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: Constraints are stored in slots, grouped into batches of BATCH_WIDTH
+ *  consecutive slots. No particle appears twice within a batch, so every
+ *  batch can be projected at once by the vectorized kernels. size() is always
+ *  a multiple of BATCH_WIDTH; unused slots are padded with disabled entries.
+ *  build_colored() additionally sorts slots by color: no two constraints of
+ *  one color share a particle, so each color range may be split freely
+ *  (at batch boundaries) across threads. build_tiled() sorts slots by grid
+ *  tile, so a tile's constraints can be swept repeatedly while in cache.
+ *  XPBD multipliers are kept per constraint id rather than per slot, so the
+ *  two tilings of the Tiled solver accumulate into the same multiplier.
+ *  Disabled constraints get no slot but keep their id, so a set rebuilt
+ *  without its dead constraints (after tearing) sweeps only the live ones
+ *  and still maps ids to the same multipliers.
+ *  The kernels report constraints longer than their tear length while they
+ *  project them (see constraint_kernel.h); tearing itself is up to the
+ *  owner of the set.
+ * ---------------------------------------------------------------------------- */
+
+#ifndef CONSTRAINTS_H
+#define CONSTRAINTS_H
+
+#include "aligned_allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace physics {
+    // static constants
+    // - constraints projected together by one kernel batch
+    const std::size_t BATCH_WIDTH = 8;
+
+    // structs
+    struct distance_constraint {
+        std::size_t a;
+        std::size_t b;
+        float rest_length;
+        float flex_coeff;
+        float compliance;
+        unsigned color;
+        float tear_ratio; // of the rest length, 0 never tears
+        bool disabled;    // gets no slot
+    };
+
+    struct constraint_set {
+        // typedefs
+        typedef std::size_t size_type;
+
+        // static constants
+        static const size_type NO_SLOT;
+
+        // solver arrays (all indexed by slot)
+        aligned_vector<std::int32_t> vertex_a;
+        aligned_vector<std::int32_t> vertex_b;
+        aligned_vector<std::int32_t> id;
+        aligned_vector<float> rest_length;
+        aligned_vector<float> compliance;
+        // - squared flex band, only lengths outside of it are resolved
+        aligned_vector<float> lower_sq;
+        aligned_vector<float> upper_sq;
+        // - squared tear length, infinite for constraints that never tear
+        aligned_vector<float> tear_sq;
+        // constraint id (index into the build list) -> slot
+        std::vector<size_type> slot;
+        // slot ranges of each group (colors or tiles), empty for build()
+        std::vector<size_type> group_begin;
+
+        // container properties
+        size_type size() const;
+        bool empty() const;
+        size_type num_groups() const;
+
+        // container manipulation
+        void clear();
+        void build(const std::vector<distance_constraint>& constraints, size_type num_particles);
+        void build_colored(const std::vector<distance_constraint>& constraints, unsigned num_colors);
+        // - particles must form a row-major grid_width^2 grid
+        void build_tiled(const std::vector<distance_constraint>& constraints, size_type grid_width, size_type tile_side, size_type tile_offset);
+        void disable(size_type id);
+
+    private:
+        // private functions
+        void _reserve(size_type n);
+        void _sort_by_group(const std::vector<unsigned>& group, unsigned num_groups, std::vector<size_type>& order, std::vector<size_type>& count);
+        void _pack_batches(const std::vector<distance_constraint>& constraints, std::vector<size_type>& ids, std::vector<size_type>& batch_stamp);
+        void _push_slot(const distance_constraint& c, size_type c_id);
+        void _push_padding();
+    };
+
+    // xpbd lagrange multipliers of one constraint list (indexed by id)
+    struct xpbd_multipliers {
+        // typedefs
+        typedef std::size_t size_type;
+
+        aligned_vector<float> lambda;
+        // 1/dt^2, turns compliance into the time step's alpha tilde
+        float inv_dt_2;
+
+        // multiplier manipulation
+        // - multipliers only live for one time step
+        void reset(size_type num_constraints, float time_step);
+    };
+
+    // inline accessors
+    inline constraint_set::size_type constraint_set::size() const {
+        return vertex_a.size();
+    }
+    inline bool constraint_set::empty() const {
+        return vertex_a.empty();
+    }
+    inline constraint_set::size_type constraint_set::num_groups() const {
+        return group_begin.empty() ? 0 : group_begin.size()-1;
+    }
+}
+
+#endif
@@ -0,0 +1,85 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: grab.cpp
+ *  Definition file for the grab constraint that drags particles with the
+ *  mouse
+ * **************************************************************************** */
+
+#include "grab.h"
+
+#include <algorithm>
+
+/* ============================================================================ *
+ * Grab Set
+ * ============================================================================ */
+void physics::grab_set::clear() {
+    vertex.clear();
+    offset.clear();
+    lambda.clear();
+    sample_time.clear();
+    sample_target.clear();
+}
+
+void physics::grab_set::add_sample(double time, const glm::vec3& target) {
+    if(!sample_time.empty() && time <= sample_time.back()) {
+        sample_target.back() = target;
+        return;
+    }
+    if(sample_time.size() == GRAB_MAX_SAMPLES) {
+        sample_time.erase(sample_time.begin());
+        sample_target.erase(sample_target.begin());
+    }
+    sample_time.push_back(time);
+    sample_target.push_back(target);
+}
+
+void physics::grab_set::discard_before(double time) {
+    // keep the last sample at or before time
+    size_type keep = 0;
+    while(keep+1 < sample_time.size() && sample_time[keep+1] <= time)
+        keep++;
+    sample_time.erase(sample_time.begin(), sample_time.begin() + keep);
+    sample_target.erase(sample_target.begin(), sample_target.begin() + keep);
+}
+
+void physics::grab_set::begin_substep(double time, float h, float compliance) {
+    target = target_at(time);
+    alpha = compliance/(h*h);
+    lambda.assign(vertex.size(), glm::vec3(0.0f));
+}
+
+glm::vec3 physics::grab_set::target_at(double time) const {
+    if(sample_time.empty())
+        return glm::vec3(0.0f);
+    if(time <= sample_time.front())
+        return sample_target.front();
+    if(time >= sample_time.back())
+        return sample_target.back();
+    // first sample after time, there are only a few
+    size_type k = std::upper_bound(sample_time.begin(), sample_time.end(), time) - sample_time.begin();
+    float s = (float)((time - sample_time[k-1])/(sample_time[k] - sample_time[k-1]));
+    return sample_target[k-1] + (sample_target[k] - sample_target[k-1])*s;
+}
+
+
+
+/* ============================================================================ *
+ * Solving
+ * ============================================================================ */
+void physics::solve_grab(particle_set& p, grab_set& g, const aligned_vector<particle_set::mask_word>& asleep) {
+    for(grab_set::size_type k=0; k<g.size(); k++) {
+        grab_set::size_type v = g.vertex[k];
+        grab_set::size_type w = v/particle_set::MASK_WORD_BITS;
+        if(p.is_pinned(v) || (w < asleep.size() && ((asleep[w] >> (v%particle_set::MASK_WORD_BITS)) & 1u)))
+            continue;
+        // C = pos - (target + offset), per axis with the same weight
+        float inv_mass = p.inv_mass[v];
+        glm::vec3 c = p.pos[v] - (g.target + g.offset[k]);
+        glm::vec3 d_lambda = (-c - g.alpha*g.lambda[k])/(inv_mass + g.alpha);
+        g.lambda[k] += d_lambda;
+        p.pos[v] += d_lambda*inv_mass;
+    }
+}
@@ -0,0 +1,93 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: grab.h
+ *  Header file for the grab constraint that drags particles with the mouse
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: A grab attaches a set of free particles to a moving target, each at
+ *  its own offset, with a compliant (xpbd) zero-length constraint per
+ *  particle. The particles stay free and keep integrating, so the cloth
+ *  pulls back on them and a released particle simply carries on with the
+ *  velocity it had. The target is given as samples stamped in simulated
+ *  time; every substep aims at the target at the end of that substep,
+ *  interpolated between the samples around it (and held at the first or
+ *  last one outside of them). Frames add a sample at the time their steps
+ *  run up to, so the steps of one frame sweep the target smoothly from the
+ *  last frame's sample to this one's instead of all running towards a
+ *  teleported one. Like the edge multipliers, the grab's multipliers
+ *  accumulate over the sweeps of one substep. The constraint is 3d rather
+ *  than a distance, so it has no direction to lose at zero length.
+ * ---------------------------------------------------------------------------- */
+
+#ifndef GRAB_H
+#define GRAB_H
+
+#include "../../lib/glm/vec3.hpp"
+
+#include "particles.h"
+#include "aligned_allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace physics {
+    // static constants
+    // - samples kept at most, the oldest are dropped past it (e.g. while no
+    //   steps run to consume them)
+    const std::size_t GRAB_MAX_SAMPLES = 32;
+
+    struct grab_set {
+        // typedefs
+        typedef std::size_t size_type;
+
+        // grabbed particles, their offsets from the target and multipliers
+        aligned_vector<std::int32_t> vertex;
+        aligned_vector<glm::vec3> offset;
+        aligned_vector<glm::vec3> lambda;
+        // target samples, in ascending time
+        std::vector<double> sample_time;
+        std::vector<glm::vec3> sample_target;
+        // target and compliance / h^2 of the current substep
+        glm::vec3 target;
+        float alpha;
+
+        // container properties
+        size_type size() const;
+        bool empty() const;
+
+        // container manipulation
+        void clear();
+        // - a sample at or before the last one replaces it
+        void add_sample(double time, const glm::vec3& target);
+        // - drops the samples that no time at or after `time` interpolates
+        //   from
+        void discard_before(double time);
+        // - aims at target_at(time) for a substep of length h, and resets
+        //   the multipliers
+        void begin_substep(double time, float h, float compliance);
+
+        // lookup
+        // - target at time, interpolated between the samples around it
+        glm::vec3 target_at(double time) const;
+    };
+
+    // - projects every grabbed particle that is neither pinned nor set in
+    //   `asleep` (same layout as particle_set::pinned) towards its offset
+    //   from the substep's target
+    void solve_grab(particle_set& p, grab_set& g, const aligned_vector<particle_set::mask_word>& asleep);
+
+    // inline accessors
+    inline grab_set::size_type grab_set::size() const {
+        return vertex.size();
+    }
+    inline bool grab_set::empty() const {
+        return vertex.empty();
+    }
+}
+
+#endif
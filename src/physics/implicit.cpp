@@ -0,0 +1,193 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: implicit.cpp
+ *  Definition file for the implicit (backward Euler) spring integrator
+ * **************************************************************************** */
+
+#include "implicit.h"
+
+#include "../../lib/glm/glm.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    double dot(const std::vector<glm::vec3>& a, const std::vector<glm::vec3>& b) {
+        double sum = 0;
+        for(std::size_t i=0; i<a.size(); i++)
+            sum += (double)a[i].x*b[i].x + (double)a[i].y*b[i].y + (double)a[i].z*b[i].z;
+        return sum;
+    }
+}
+
+/* ============================================================================ *
+ * Block CSR Matrix
+ * ============================================================================ */
+physics::block_csr_matrix::size_type physics::block_csr_matrix::rows() const {
+    return row_begin.empty() ? 0 : row_begin.size()-1;
+}
+
+physics::block_csr_matrix::size_type physics::block_csr_matrix::find(size_type i, size_type j) const {
+    // columns are sorted within a row
+    auto begin = column.begin() + row_begin[i];
+    auto end = column.begin() + row_begin[i+1];
+    return std::lower_bound(begin, end, (std::int32_t)j) - column.begin();
+}
+
+void physics::block_csr_matrix::multiply(const std::vector<glm::vec3>& x, std::vector<glm::vec3>& y) const {
+    for(size_type i=0; i<rows(); i++) {
+        glm::vec3 sum(0);
+        for(size_type k=row_begin[i]; k<row_begin[i+1]; k++)
+            sum += value[k]*x[column[k]];
+        y[i] = sum;
+    }
+}
+
+
+
+/* ============================================================================ *
+ * Implicit System
+ * ============================================================================ */
+void physics::implicit_system::build(size_type num_particles, const std::vector<distance_constraint>& edges) {
+    clear();
+    // pattern, every particle couples to itself and its spring neighbors
+    std::vector<std::vector<std::int32_t>> columns(num_particles);
+    for(size_type i=0; i<num_particles; i++)
+        columns[i].push_back(i);
+    for(auto it=edges.begin(); it!=edges.end(); ++it) {
+        columns[it->a].push_back(it->b);
+        columns[it->b].push_back(it->a);
+    }
+    matrix.row_begin.push_back(0);
+    for(size_type i=0; i<num_particles; i++) {
+        std::sort(columns[i].begin(), columns[i].end());
+        columns[i].erase(std::unique(columns[i].begin(), columns[i].end()), columns[i].end());
+        matrix.column.insert(matrix.column.end(), columns[i].begin(), columns[i].end());
+        matrix.row_begin.push_back(matrix.column.size());
+    }
+    matrix.value.resize(matrix.column.size());
+    diagonal.resize(num_particles);
+    for(size_type i=0; i<num_particles; i++)
+        diagonal[i] = matrix.find(i, i);
+    springs.reserve(edges.size());
+    for(auto it=edges.begin(); it!=edges.end(); ++it) {
+        springs.push_back({it->a, it->b, it->rest_length, 1.0f/it->compliance,
+            diagonal[it->a], diagonal[it->b], matrix.find(it->a, it->b), matrix.find(it->b, it->a)});
+    }
+    dv.assign(num_particles, glm::vec3(0));
+    rhs.resize(num_particles);
+    r.resize(num_particles);
+    z.resize(num_particles);
+    dir.resize(num_particles);
+    ap.resize(num_particles);
+    precond.resize(num_particles);
+}
+
+void physics::implicit_system::clear() {
+    springs.clear();
+    matrix.row_begin.clear();
+    matrix.column.clear();
+    matrix.value.clear();
+    diagonal.clear();
+    dv.clear();
+}
+
+bool physics::implicit_system::empty() const {
+    return diagonal.empty();
+}
+
+physics::implicit_system::size_type physics::implicit_system::step(particle_set& p, const glm::vec3& a_gravity, const glm::vec3& f_wind, float h, size_type max_iterations, float tolerance) {
+    size_type n = p.size();
+    const glm::mat3 identity(1.0f);
+
+    // assemble A = M - h^2 K and b = h (f + h K v)
+    for(size_type i=0; i<n; i++) {
+        if(p.is_pinned(i)) {
+            matrix.value[diagonal[i]] = identity;
+            rhs[i] = glm::vec3(0);
+        }
+        else {
+            matrix.value[diagonal[i]] = identity/p.inv_mass[i];
+            rhs[i] = h*(a_gravity/p.inv_mass[i] + f_wind);
+        }
+    }
+    for(auto it=springs.begin(); it!=springs.end(); ++it) {
+        matrix.value[it->ab] = glm::mat3(0.0f);
+        matrix.value[it->ba] = glm::mat3(0.0f);
+    }
+    for(auto it=springs.begin(); it!=springs.end(); ++it) {
+        bool free_a = !p.is_pinned(it->a);
+        bool free_b = !p.is_pinned(it->b);
+        if(!free_a && !free_b)
+            continue;
+        glm::vec3 d = p.pos[it->a] - p.pos[it->b];
+        float len = glm::length(d);
+        if(len <= 0)
+            continue;
+        glm::vec3 u = d/len;
+        glm::mat3 uu = glm::outerProduct(u, u);
+        // K_aa = -k (uu^T + max(0, 1 - L/l)(I - uu^T))
+        float transverse = std::max(0.0f, 1.0f - it->rest_length/len);
+        glm::mat3 k_aa = -it->stiffness*(uu + transverse*(identity - uu));
+        glm::vec3 f_a = -it->stiffness*(len - it->rest_length)*u;
+        glm::vec3 v_ab = ((p.pos[it->a] - p.pos_old[it->a]) - (p.pos[it->b] - p.pos_old[it->b]))/h;
+        glm::vec3 b_a = h*(f_a + h*(k_aa*v_ab));
+        glm::mat3 a_aa = -h*h*k_aa;
+        if(free_a) {
+            matrix.value[it->aa] += a_aa;
+            rhs[it->a] += b_a;
+        }
+        if(free_b) {
+            matrix.value[it->bb] += a_aa;
+            rhs[it->b] -= b_a;
+        }
+        if(free_a && free_b) {
+            matrix.value[it->ab] -= a_aa;
+            matrix.value[it->ba] -= a_aa;
+        }
+    }
+
+    // preconditioned conjugate gradients from the previous solution
+    for(size_type i=0; i<n; i++) {
+        precond[i] = glm::inverse(matrix.value[diagonal[i]]);
+        if(p.is_pinned(i))
+            dv[i] = glm::vec3(0);
+    }
+    matrix.multiply(dv, ap);
+    for(size_type i=0; i<n; i++) {
+        r[i] = rhs[i] - ap[i];
+        z[i] = precond[i]*r[i];
+        dir[i] = z[i];
+    }
+    double rz = dot(r, z);
+    double limit = (double)tolerance*tolerance*dot(rhs, rhs);
+    size_type iterations = 0;
+    while(iterations < max_iterations && dot(r, r) > limit) {
+        matrix.multiply(dir, ap);
+        double alpha = rz/dot(dir, ap);
+        for(size_type i=0; i<n; i++) {
+            dv[i] += (float)alpha*dir[i];
+            r[i] -= (float)alpha*ap[i];
+            z[i] = precond[i]*r[i];
+        }
+        double rz_next = dot(r, z);
+        float beta = (float)(rz_next/rz);
+        rz = rz_next;
+        for(size_type i=0; i<n; i++)
+            dir[i] = z[i] + beta*dir[i];
+        iterations++;
+    }
+
+    // v += dv, x += h v
+    for(size_type i=0; i<n; i++) {
+        if(p.is_pinned(i))
+            continue;
+        glm::vec3 step = (p.pos[i] - p.pos_old[i]) + h*dv[i];
+        p.pos_old[i] = p.pos[i];
+        p.pos[i] += step;
+    }
+    return iterations;
+}
@@ -0,0 +1,91 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: implicit.h
+ *  Header file for the implicit (backward Euler) spring integrator
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: Every edge is a spring of stiffness 1/compliance. A step linearizes
+ *  the spring forces once (Baraff & Witkin) and solves
+ *      (M - h^2 K) dv = h (f + h K v)
+ *  for the velocity change, K = df/dx. The spring jacobian drops its
+ *  transverse term while a spring is compressed, which keeps the matrix
+ *  symmetric positive definite, so it is solved by conjugate gradients with
+ *  a block Jacobi preconditioner, starting from the previous step's dv.
+ *  The matrix is stored in block CSR (3x3 blocks): the sparsity pattern only
+ *  depends on the edges and is built once per topology, only the values are
+ *  assembled every step. Pinned particles are filtered out of the system
+ *  (identity rows, no couplings), so their velocity change is always 0.
+ * ---------------------------------------------------------------------------- */
+
+#ifndef IMPLICIT_H
+#define IMPLICIT_H
+
+#include "../../lib/glm/vec3.hpp"
+#include "../../lib/glm/mat3x3.hpp"
+
+#include "particles.h"
+#include "constraints.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace physics {
+    // square sparse matrix of 3x3 blocks, compressed by rows
+    struct block_csr_matrix {
+        // typedefs
+        typedef std::size_t size_type;
+
+        // - row i holds blocks row_begin[i] ... row_begin[i+1]-1
+        std::vector<size_type> row_begin;
+        std::vector<std::int32_t> column;
+        std::vector<glm::mat3> value;
+
+        size_type rows() const;
+        // - slot of block (i, j), which must be in the pattern
+        size_type find(size_type i, size_type j) const;
+        void multiply(const std::vector<glm::vec3>& x, std::vector<glm::vec3>& y) const;
+    };
+
+    struct implicit_system {
+        // typedefs
+        typedef std::size_t size_type;
+
+        struct spring {
+            size_type a;
+            size_type b;
+            float rest_length;
+            float stiffness;
+            // blocks (a, a), (b, b), (a, b), (b, a)
+            size_type aa;
+            size_type bb;
+            size_type ab;
+            size_type ba;
+        };
+
+        std::vector<spring> springs;
+        block_csr_matrix matrix;
+        std::vector<size_type> diagonal; // slot of block (i, i)
+        // - previous step's solution, the next step's initial guess
+        std::vector<glm::vec3> dv;
+        // - solver scratch
+        std::vector<glm::vec3> rhs, r, z, dir, ap;
+        std::vector<glm::mat3> precond;
+
+        // - springs weigh 1/compliance, inactive edges must be left out
+        void build(size_type num_particles, const std::vector<distance_constraint>& edges);
+        void clear();
+        bool empty() const;
+
+        // - one linearized backward euler step of length h from the verlet
+        //   state (pos, pos_old), whose velocities are implied over h
+        // - returns the number of conjugate gradient iterations
+        size_type step(particle_set& p, const glm::vec3& a_gravity, const glm::vec3& f_wind, float h, size_type max_iterations, float tolerance);
+    };
+}
+
+#endif
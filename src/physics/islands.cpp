@@ -0,0 +1,240 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: islands.cpp
+ *  Definition file for the connected components (islands) of a torn cloth
+ * **************************************************************************** */
+
+#include "islands.h"
+
+#include <algorithm>
+
+/* ============================================================================ *
+ * Static Constant Definitions
+ * ============================================================================ */
+const std::int32_t
+physics::island_set::NO_ISLAND;
+
+
+
+/* ============================================================================ *
+ * Disjoint Sets
+ * ============================================================================ */
+void physics::disjoint_sets::reset(size_type n) {
+    parent.resize(n);
+    count.assign(n, 1);
+    for(size_type i=0; i<n; i++)
+        parent[i] = (std::int32_t)i;
+}
+
+physics::disjoint_sets::size_type physics::disjoint_sets::find(size_type i) {
+    while((size_type)parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+void physics::disjoint_sets::unite(size_type a, size_type b) {
+    a = find(a);
+    b = find(b);
+    if(a == b)
+        return;
+    if(count[a] < count[b])
+        std::swap(a, b);
+    parent[b] = (std::int32_t)a;
+    count[a] += count[b];
+}
+
+
+
+/* ============================================================================ *
+ * Container Properties
+ * ============================================================================ */
+physics::island_set::size_type physics::island_set::size() const {
+    return asleep.size();
+}
+
+
+
+/* ============================================================================ *
+ * Container Manipulation
+ * ============================================================================ */
+void physics::island_set::clear() {
+    island_of.clear();
+    asleep_mask.clear();
+    begin.clear();
+    end.clear();
+    particles.clear();
+    calm_steps.clear();
+    asleep.clear();
+}
+
+void physics::island_set::build(size_type num_particles, const std::vector<size_type>& members, const std::vector<distance_constraint>& edges) {
+    // the old islands, to inherit sleep state from
+    std::vector<std::int32_t> old_island_of;
+    std::vector<size_type> old_calm_steps;
+    std::vector<std::uint8_t> old_asleep;
+    old_island_of.swap(island_of);
+    old_calm_steps.swap(calm_steps);
+    old_asleep.swap(asleep);
+    _local.assign(num_particles, -1);
+
+    disjoint_sets sets;
+    sets.reset(num_particles);
+    for(auto it=edges.begin(); it!=edges.end(); ++it)
+        sets.unite(it->a, it->b);
+
+    // number the roots in member order, then bucket the members
+    island_of.assign(num_particles, NO_ISLAND);
+    std::vector<std::int32_t> root_island(num_particles, NO_ISLAND);
+    begin.assign(1, 0);
+    for(auto it=members.begin(); it!=members.end(); ++it) {
+        size_type r = sets.find(*it);
+        if(root_island[r] == NO_ISLAND) {
+            root_island[r] = (std::int32_t)(begin.size() - 1);
+            begin.push_back(0);
+        }
+        island_of[*it] = root_island[r];
+        begin[island_of[*it]+1]++;
+    }
+    for(size_type i=1; i<begin.size(); i++)
+        begin[i] += begin[i-1];
+    particles.resize(members.size());
+    end.assign(begin.begin(), begin.end()-1);
+    begin.pop_back();
+    for(auto it=members.begin(); it!=members.end(); ++it)
+        particles[end[island_of[*it]]++] = *it;
+
+    // islands only split, so every particle of a new island was in the same
+    // old one
+    calm_steps.assign(begin.size(), 0);
+    asleep.assign(begin.size(), 0);
+    for(size_type i=0; i<size(); i++) {
+        size_type v = particles[begin[i]];
+        if(v < old_island_of.size() && old_island_of[v] != NO_ISLAND) {
+            calm_steps[i] = old_calm_steps[old_island_of[v]];
+            asleep[i] = old_asleep[old_island_of[v]];
+        }
+    }
+    asleep_mask.assign((num_particles + particle_set::MASK_WORD_BITS - 1)/particle_set::MASK_WORD_BITS, 0);
+    for(size_type i=0; i<size(); i++) {
+        if(!asleep[i])
+            continue;
+        for(size_type k=begin[i]; k<end[i]; k++)
+            asleep_mask[particles[k]/particle_set::MASK_WORD_BITS] |= mask_word(1) << (particles[k]%particle_set::MASK_WORD_BITS);
+    }
+}
+
+physics::island_set::size_type physics::island_set::split(size_type island, const std::vector<size_type>& members, const std::vector<distance_constraint>& edges) {
+    // the particles that left take their asleep bit with them
+    for(size_type k=begin[island]; k<end[island]; k++) {
+        size_type v = particles[k];
+        island_of[v] = NO_ISLAND;
+        asleep_mask[v/particle_set::MASK_WORD_BITS] &= ~(mask_word(1) << (v%particle_set::MASK_WORD_BITS));
+    }
+    for(size_type k=0; k<members.size(); k++)
+        _local[members[k]] = (std::int32_t)k;
+    disjoint_sets sets;
+    sets.reset(members.size());
+    for(auto it=edges.begin(); it!=edges.end(); ++it)
+        sets.unite(_local[it->a], _local[it->b]);
+
+    // number the pieces in member order, the first keeps the island's id
+    std::vector<std::int32_t> piece(members.size(), NO_ISLAND);
+    std::vector<size_type> count;
+    for(size_type k=0; k<members.size(); k++) {
+        size_type r = sets.find(k);
+        if(piece[r] == NO_ISLAND) {
+            piece[r] = (std::int32_t)count.size();
+            count.push_back(0);
+        }
+        count[piece[r]]++;
+    }
+    std::vector<size_type> ids(count.size(), island);
+    size_type first = begin[island];
+    for(size_type c=0; c<count.size(); c++) {
+        if(c > 0) {
+            ids[c] = size();
+            begin.push_back(0);
+            end.push_back(0);
+            calm_steps.push_back(calm_steps[island]);
+            asleep.push_back(asleep[island]);
+        }
+        begin[ids[c]] = first;
+        end[ids[c]] = first;
+        first += count[c];
+    }
+    if(count.empty())
+        end[island] = begin[island];
+    for(size_type k=0; k<members.size(); k++) {
+        size_type v = members[k];
+        size_type id = ids[piece[sets.find(k)]];
+        particles[end[id]++] = v;
+        island_of[v] = (std::int32_t)id;
+        if(asleep[id])
+            asleep_mask[v/particle_set::MASK_WORD_BITS] |= mask_word(1) << (v%particle_set::MASK_WORD_BITS);
+        _local[v] = -1;
+    }
+    return count.size();
+}
+
+
+
+/* ============================================================================ *
+ * Sleeping
+ * ============================================================================ */
+void physics::island_set::update_sleep(particle_set& p, float max_disp_sq, size_type sleep_steps, std::vector<size_type>& fell_asleep) {
+    for(size_type i=0; i<size(); i++) {
+        // islands left empty by erasures stay awake, there is nothing to skip
+        if(asleep[i] || begin[i] == end[i])
+            continue;
+        // kinetic energy test on the fastest particle
+        float disp_sq = 0;
+        for(size_type k=begin[i]; k<end[i] && disp_sq <= max_disp_sq; k++) {
+            glm::vec3 d = p.pos[particles[k]] - p.pos_old[particles[k]];
+            disp_sq = std::max(disp_sq, d.x*d.x + d.y*d.y + d.z*d.z);
+        }
+        if(disp_sq > max_disp_sq) {
+            calm_steps[i] = 0;
+            continue;
+        }
+        if(++calm_steps[i] < sleep_steps)
+            continue;
+        // fall asleep at rest
+        asleep[i] = 1;
+        fell_asleep.push_back(i);
+        for(size_type k=begin[i]; k<end[i]; k++) {
+            size_type v = particles[k];
+            p.pos_old[v] = p.pos[v];
+            asleep_mask[v/particle_set::MASK_WORD_BITS] |= mask_word(1) << (v%particle_set::MASK_WORD_BITS);
+        }
+    }
+}
+
+bool physics::island_set::wake_particle(size_type i) {
+    if(i >= island_of.size() || island_of[i] == NO_ISLAND)
+        return false;
+    return wake(island_of[i]);
+}
+
+bool physics::island_set::wake(size_type island) {
+    calm_steps[island] = 0;
+    if(!asleep[island])
+        return false;
+    asleep[island] = 0;
+    for(size_type k=begin[island]; k<end[island]; k++) {
+        size_type v = particles[k];
+        asleep_mask[v/particle_set::MASK_WORD_BITS] &= ~(mask_word(1) << (v%particle_set::MASK_WORD_BITS));
+    }
+    return true;
+}
+
+bool physics::island_set::wake_all() {
+    bool woke = false;
+    for(size_type i=0; i<size(); i++)
+        woke |= wake(i);
+    return woke;
+}
@@ -0,0 +1,113 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: islands.h
+ *  Header file for the connected components (islands) of a torn cloth
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: An island is a set of particles connected by live edges, found with
+ *  a union-find pass over the edges. Tearing only ever splits islands, so it
+ *  is kept up incrementally: after a commit, only the islands that lost an
+ *  edge or a particle are re-split, by a union-find over their own particles
+ *  and edges. The first piece keeps the island's id and the others are
+ *  appended, all with its sleep state, and every piece stays within the
+ *  island's old range of `particles`, so nothing else moves. Splitting
+ *  still walks the whole torn island (a single tear in an intact cloth
+ *  costs as much as a full build), but resting scraps are never revisited.
+ *  Union-find cannot undo a union, so a split is a fresh pass over the
+ *  island rather than an update of the old sets.
+ *  An island falls asleep after its fastest particle has moved less than
+ *  the sleep threshold for a number of consecutive steps; its velocities
+ *  are zeroed, and its particles are set in the asleep mask (same layout as
+ *  particle_set::pinned) until something wakes it. The owner is expected
+ *  to skip asleep particles and their constraints.
+ * ---------------------------------------------------------------------------- */
+
+#ifndef ISLANDS_H
+#define ISLANDS_H
+
+#include "particles.h"
+#include "constraints.h"
+#include "aligned_allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace physics {
+    struct disjoint_sets {
+        // typedefs
+        typedef std::size_t size_type;
+
+        std::vector<std::int32_t> parent;
+        std::vector<std::int32_t> count; // of a root's set
+
+        void reset(size_type n);
+        // - with path halving
+        size_type find(size_type i);
+        // - the smaller set joins the larger one
+        void unite(size_type a, size_type b);
+    };
+
+    struct island_set {
+        // typedefs
+        typedef std::size_t size_type;
+        typedef particle_set::mask_word mask_word;
+
+        // static constants
+        static const std::int32_t NO_ISLAND = -1;
+
+        // per particle
+        std::vector<std::int32_t> island_of;
+        aligned_vector<mask_word> asleep_mask;
+        // per island, its particles are particles[begin[i] ... end[i]-1]
+        std::vector<size_type> begin;
+        std::vector<size_type> end;
+        std::vector<size_type> particles;
+        std::vector<size_type> calm_steps;
+        std::vector<std::uint8_t> asleep;
+
+        // container properties
+        size_type size() const;
+        bool is_asleep(size_type i) const;
+
+        // container manipulation
+        void clear();
+        // - islands over the given particles (any other particle is in none)
+        //   and the edges between them
+        void build(size_type num_particles, const std::vector<size_type>& members, const std::vector<distance_constraint>& edges);
+        // - re-splits an island that lost edges or particles, members are
+        //   the particles left in it and edges the live edges between them
+        // - returns the number of islands it was split into (0 if none of
+        //   its particles is left)
+        size_type split(size_type island, const std::vector<size_type>& members, const std::vector<distance_constraint>& edges);
+
+        // sleeping
+        // - steps the sleep test of every awake island, an island whose
+        //   particles all moved at most sqrt(max_disp_sq) since pos_old for
+        //   sleep_steps steps falls asleep
+        // - appends the islands that fell asleep to fell_asleep
+        void update_sleep(particle_set& p, float max_disp_sq, size_type sleep_steps, std::vector<size_type>& fell_asleep);
+        // - wake the island of particle i, returns whether it was asleep
+        bool wake_particle(size_type i);
+        bool wake(size_type island);
+        // - returns whether any island was asleep
+        bool wake_all();
+
+    private:
+        // split scratch, particle -> index in the island's members (-1
+        // outside of a split)
+        std::vector<std::int32_t> _local;
+    };
+
+    // inline accessors (used by the integrator)
+    inline bool island_set::is_asleep(size_type i) const {
+        return i/particle_set::MASK_WORD_BITS < asleep_mask.size()
+            && ((asleep_mask[i/particle_set::MASK_WORD_BITS] >> (i%particle_set::MASK_WORD_BITS)) & 1u);
+    }
+}
+
+#endif
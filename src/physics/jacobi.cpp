@@ -0,0 +1,155 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: jacobi.cpp
+ *  Definition file for the parallel Jacobi constraint sweep
+ * **************************************************************************** */
+
+#include "jacobi.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+/* ============================================================================ *
+ * Jacobi Buffers
+ * ============================================================================ */
+void physics::jacobi_buffers::build(const constraint_set& c, size_type num_particles) {
+    clear();
+    // counting sort of the slots by particle, ascending within a particle
+    row_begin.assign(num_particles+1, 0);
+    for(size_type k=0; k<c.size(); k++) {
+        if(c.vertex_a[k] == c.vertex_b[k])
+            continue; // padding
+        row_begin[c.vertex_a[k]+1]++;
+        row_begin[c.vertex_b[k]+1]++;
+    }
+    for(size_type i=0; i<num_particles; i++)
+        row_begin[i+1] += row_begin[i];
+    std::vector<size_type> fill(row_begin.begin(), row_begin.end()-1);
+    end.resize(row_begin[num_particles]);
+    for(size_type k=0; k<c.size(); k++) {
+        if(c.vertex_a[k] == c.vertex_b[k])
+            continue;
+        end[fill[c.vertex_a[k]]++] = 2*k;
+        end[fill[c.vertex_b[k]]++] = 2*k + 1;
+    }
+    delta.assign(2*c.size(), glm::vec3(0));
+    block_error.resize((c.size() + JACOBI_BLOCK - 1)/JACOBI_BLOCK);
+}
+
+void physics::jacobi_buffers::clear() {
+    row_begin.clear();
+    end.clear();
+    delta.clear();
+    block_error.clear();
+}
+
+
+
+/* ============================================================================ *
+ * Jacobi Sweep
+ * ============================================================================ */
+// projects slots [begin, end) against the current positions without moving
+// them, the corrections of unresolved slots are 0
+// - xpbd corrections are already relaxed, see solve_jacobi_sweep()
+static std::size_t project_block(const physics::particle_set& p, const physics::constraint_set& c, physics::jacobi_buffers& j, float relaxation, physics::xpbd_multipliers* m, std::size_t begin, std::size_t end, physics::constraint_error& err) {
+    const float infinity = std::numeric_limits<float>::infinity();
+    std::size_t count_resolved = 0;
+    err.clear();
+    for(std::size_t k=begin; k<end; k++) {
+        j.delta[2*k] = glm::vec3(0);
+        j.delta[2*k+1] = glm::vec3(0);
+        std::int32_t a = c.vertex_a[k];
+        std::int32_t b = c.vertex_b[k];
+        glm::vec3 v_diff = p.pos[b] - p.pos[a];
+        float v_diff_length_2 = v_diff.x*v_diff.x + v_diff.y*v_diff.y + v_diff.z*v_diff.z;
+        float w_a = p.weight(a);
+        float w_b = p.weight(b);
+        float w_sum = w_a + w_b;
+        float rest = c.rest_length[k];
+        float e;
+        float s;
+        if(m) {
+            // same compliant update as the xpbd kernels
+            if(!(c.upper_sq[k] < infinity && w_sum != 0.0f && v_diff_length_2 > 0.0f))
+                continue;
+            if(v_diff_length_2 < c.lower_sq[k] || v_diff_length_2 > c.upper_sq[k]) {
+                count_resolved++;
+                if(v_diff_length_2 > c.tear_sq[k])
+                    err.overstretched.push_back(c.id[k]);
+            }
+            float v_diff_length = std::sqrt(v_diff_length_2);
+            float& lambda = m->lambda[c.id[k]];
+            float alpha = c.compliance[k]*m->inv_dt_2;
+            float residual = (rest - v_diff_length) - alpha*lambda;
+            e = std::abs(residual) / rest;
+            // the multiplier takes only the step both ends actually move by,
+            // relaxed by the busier end's constraint count
+            std::size_t n_a = j.row_begin[a+1] - j.row_begin[a];
+            std::size_t n_b = j.row_begin[b+1] - j.row_begin[b];
+            float d_lambda = residual / (w_sum + alpha) * (relaxation/std::max(n_a, n_b));
+            lambda += d_lambda;
+            s = -d_lambda / v_diff_length;
+        }
+        else {
+            // same flex band projection as the distance kernels
+            if(!(v_diff_length_2 < c.lower_sq[k] || v_diff_length_2 > c.upper_sq[k]))
+                continue;
+            if(!(w_sum != 0.0f))
+                continue;
+            if(v_diff_length_2 > c.tear_sq[k])
+                err.overstretched.push_back(c.id[k]);
+            e = std::max(v_diff_length_2 - c.upper_sq[k], c.lower_sq[k] - v_diff_length_2) / (2.0f*(rest*rest));
+            float v_diff_length = std::sqrt(v_diff_length_2);
+            s = (v_diff_length - rest) / v_diff_length / w_sum;
+            count_resolved++;
+        }
+        err.max = std::max(err.max, e);
+        err.sum_sq += e*e;
+        j.delta[2*k] = v_diff*(s*w_a);
+        j.delta[2*k+1] = -v_diff*(s*w_b);
+    }
+    return count_resolved;
+}
+
+std::size_t physics::solve_jacobi_sweep(particle_set& p, const constraint_set& c, jacobi_buffers& j, ThreadPool& pool, float relaxation, xpbd_multipliers* m, constraint_error* err) {
+    std::atomic<std::size_t> count_resolved(0);
+    std::size_t num_blocks = j.block_error.size();
+    std::size_t num_particles = p.size();
+    pool.run([&](std::size_t thread, std::size_t num_threads) {
+        // project, whole blocks per thread
+        std::size_t count = 0;
+        for(std::size_t blk=num_blocks*thread/num_threads; blk<num_blocks*(thread+1)/num_threads; blk++) {
+            std::size_t begin = blk*JACOBI_BLOCK;
+            std::size_t end = std::min(begin + JACOBI_BLOCK, c.size());
+            count += project_block(p, c, j, relaxation, m, begin, end, j.block_error[blk]);
+        }
+        count_resolved.fetch_add(count, std::memory_order_relaxed);
+        // every correction must be written before any is gathered
+        pool.barrier();
+        // gather, averaged over the particle's resolved constraints (xpbd
+        // corrections are summed as they are)
+        for(std::size_t i=num_particles*thread/num_threads; i<num_particles*(thread+1)/num_threads; i++) {
+            glm::vec3 sum(0);
+            unsigned n = 0;
+            for(std::size_t k=j.row_begin[i]; k<j.row_begin[i+1]; k++) {
+                const glm::vec3& d = j.delta[j.end[k]];
+                if(d.x != 0.0f || d.y != 0.0f || d.z != 0.0f) {
+                    sum += d;
+                    n++;
+                }
+            }
+            if(n)
+                p.pos[i] += m ? sum : sum*(relaxation/n);
+        }
+    });
+    if(err) {
+        for(std::size_t blk=0; blk<num_blocks; blk++)
+            err->merge(j.block_error[blk]);
+    }
+    return count_resolved.load();
+}
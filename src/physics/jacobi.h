@@ -0,0 +1,76 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: jacobi.h
+ *  Header file for the parallel Jacobi constraint sweep
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: A Jacobi sweep projects every constraint against the positions of
+ *  the previous sweep, then moves each particle by the relaxed average of the
+ *  corrections of its constraints. Neither pass writes anything another
+ *  item reads: the first writes one correction pair per slot, the second
+ *  gathers each particle's corrections in ascending slot order through a
+ *  fixed incidence list. So the result does not depend on the thread count
+ *  or scheduling, and any edge set works, no coloring or packing needed.
+ *  The sweep error is reduced per fixed block of JACOBI_BLOCK slots and the
+ *  blocks are merged in order, so even sum_sq is reproducible.
+ *  Jacobi converges more slowly per sweep than Gauss-Seidel, the relaxation
+ *  factor (> 1) makes up part of that.
+ *  In xpbd mode averaging would apply only part of each multiplier step, so
+ *  the step itself is scaled by relaxation over the larger constraint count
+ *  of its two particles and both ends move by exactly that step, which is
+ *  also what the multiplier accumulates. A particle's corrections are then
+ *  summed instead of averaged; each is at most its share, so the sum stays
+ *  within the relaxed average.
+ * ---------------------------------------------------------------------------- */
+
+#ifndef JACOBI_H
+#define JACOBI_H
+
+#include "../../lib/glm/vec3.hpp"
+
+#include "particles.h"
+#include "constraints.h"
+#include "constraint_kernel.h"
+#include "aligned_allocator.h"
+#include "thread_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace physics {
+    // static constants
+    // - slots per error reduction block
+    const std::size_t JACOBI_BLOCK = 1024;
+
+    struct jacobi_buffers {
+        // typedefs
+        typedef std::size_t size_type;
+
+        // incidence, particle i's corrections are
+        // delta[end[row_begin[i]]] ... delta[end[row_begin[i+1]-1]]
+        std::vector<size_type> row_begin;
+        std::vector<std::int32_t> end;
+        // corrections of the last sweep, 2*slot for vertex_a, 2*slot+1 for
+        // vertex_b
+        aligned_vector<glm::vec3> delta;
+        // - error of each block of slots
+        std::vector<constraint_error> block_error;
+
+        // - any slot layout of c works, padding is skipped
+        void build(const constraint_set& c, size_type num_particles);
+        void clear();
+    };
+
+    // - one jacobi sweep, corrections are averaged over each particle's
+    //   constraints and scaled by relaxation (xpbd steps are scaled before
+    //   they are applied and summed instead, see above)
+    // - returns the number of constraints that were resolved
+    std::size_t solve_jacobi_sweep(particle_set& p, const constraint_set& c, jacobi_buffers& j, ThreadPool& pool, float relaxation, xpbd_multipliers* m=nullptr, constraint_error* err=nullptr);
+}
+
+#endif
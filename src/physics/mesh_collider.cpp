@@ -0,0 +1,430 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: mesh_collider.cpp
+ *  Definition file for the static triangle mesh collider and its bounding
+ *  volume hierarchy
+ * **************************************************************************** */
+
+#include "mesh_collider.h"
+#include "colliders.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+// deeper than this, nodes split at the median, so no hierarchy gets deeper
+// than BVH_MAX_SAH_DEPTH + log2(triangles) < BVH_STACK_SIZE
+static const std::size_t BVH_MAX_SAH_DEPTH = 32;
+static const std::size_t BVH_STACK_SIZE = 72;
+
+static float dot(const glm::vec3& a, const glm::vec3& b) {
+    return a.x*b.x + a.y*b.y + a.z*b.z;
+}
+
+static glm::vec3 cross(const glm::vec3& a, const glm::vec3& b) {
+    return glm::vec3(a.y*b.z - a.z*b.y, a.z*b.x - a.x*b.z, a.x*b.y - a.y*b.x);
+}
+
+static glm::vec3 min3(const glm::vec3& a, const glm::vec3& b) {
+    return glm::vec3(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+}
+
+static glm::vec3 max3(const glm::vec3& a, const glm::vec3& b) {
+    return glm::vec3(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+}
+
+// bounds of a set of triangles or centroids
+struct bounds {
+    glm::vec3 lo;
+    glm::vec3 hi;
+
+    bounds()
+        : lo(std::numeric_limits<float>::infinity())
+        , hi(-std::numeric_limits<float>::infinity())
+    {}
+    void grow(const glm::vec3& p) {
+        lo = min3(lo, p);
+        hi = max3(hi, p);
+    }
+    void grow(const bounds& o) {
+        lo = min3(lo, o.lo);
+        hi = max3(hi, o.hi);
+    }
+    float half_area() const {
+        if(!(lo.x <= hi.x))
+            return 0.0f;
+        glm::vec3 d = hi - lo;
+        return d.x*d.y + d.y*d.z + d.z*d.x;
+    }
+};
+
+
+
+/* ============================================================================ *
+ * Container Properties
+ * ============================================================================ */
+bool physics::mesh_collider::empty() const {
+    return triangles.empty();
+}
+
+
+
+/* ============================================================================ *
+ * Hierarchy Build
+ * ============================================================================ */
+// builds the subtree over triangles [begin, end) of tris at nodes[index]
+static void build_node(std::vector<physics::mesh_bvh_node>& nodes, std::vector<physics::mesh_triangle>& tris, std::vector<glm::vec3>& centroids, std::size_t index, std::size_t begin, std::size_t end, std::size_t depth) {
+    const std::size_t num_bins = physics::MESH_BVH_BINS;
+    bounds node_bounds;
+    bounds centroid_bounds;
+    for(std::size_t t=begin; t<end; t++) {
+        node_bounds.grow(tris[t].a);
+        node_bounds.grow(tris[t].b);
+        node_bounds.grow(tris[t].c);
+        centroid_bounds.grow(centroids[t]);
+    }
+    nodes[index].lo = node_bounds.lo;
+    nodes[index].hi = node_bounds.hi;
+    std::size_t count = end - begin;
+    if(count <= physics::MESH_BVH_LEAF_SIZE) {
+        nodes[index].first = (std::uint32_t)begin;
+        nodes[index].count = (std::uint32_t)count;
+        return;
+    }
+
+    // cheapest binned split over all three axes
+    float best_cost = std::numeric_limits<float>::infinity();
+    int best_axis = -1;
+    std::size_t best_bin = 0;
+    for(int axis=0; axis<3 && depth<BVH_MAX_SAH_DEPTH; axis++) {
+        float extent = centroid_bounds.hi[axis] - centroid_bounds.lo[axis];
+        if(!(extent > 0.0f))
+            continue;
+        float scale = num_bins/extent;
+        bounds bin_bounds[num_bins];
+        std::size_t bin_count[num_bins] = {};
+        for(std::size_t t=begin; t<end; t++) {
+            std::size_t bin = std::min(num_bins-1, (std::size_t)((centroids[t][axis] - centroid_bounds.lo[axis])*scale));
+            bin_count[bin]++;
+            bin_bounds[bin].grow(tris[t].a);
+            bin_bounds[bin].grow(tris[t].b);
+            bin_bounds[bin].grow(tris[t].c);
+        }
+        // cost of splitting after each bin, from both sides
+        float right_cost[num_bins];
+        bounds right;
+        std::size_t right_count = 0;
+        for(std::size_t k=num_bins-1; k>0; k--) {
+            right.grow(bin_bounds[k]);
+            right_count += bin_count[k];
+            right_cost[k-1] = right_count*right.half_area();
+        }
+        bounds left;
+        std::size_t left_count = 0;
+        for(std::size_t k=0; k<num_bins-1; k++) {
+            left.grow(bin_bounds[k]);
+            left_count += bin_count[k];
+            float cost = left_count*left.half_area() + right_cost[k];
+            if(left_count > 0 && left_count < count && cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                best_bin = k;
+            }
+        }
+    }
+
+    // partition, by the best bin or (all centroids equal, or too deep) by
+    // index
+    std::size_t mid;
+    if(best_axis >= 0) {
+        int axis = best_axis;
+        float lo = centroid_bounds.lo[axis];
+        float scale = num_bins/(centroid_bounds.hi[axis] - lo);
+        std::size_t i = begin;
+        std::size_t j = end;
+        while(i < j) {
+            std::size_t bin = std::min(num_bins-1, (std::size_t)((centroids[i][axis] - lo)*scale));
+            if(bin <= best_bin) {
+                i++;
+            }
+            else {
+                j--;
+                std::swap(tris[i], tris[j]);
+                std::swap(centroids[i], centroids[j]);
+            }
+        }
+        mid = i;
+    }
+    else {
+        mid = begin + count/2;
+    }
+
+    std::size_t left = nodes.size();
+    nodes.push_back(physics::mesh_bvh_node());
+    build_node(nodes, tris, centroids, left, begin, mid, depth+1);
+    std::size_t right = nodes.size();
+    nodes.push_back(physics::mesh_bvh_node());
+    build_node(nodes, tris, centroids, right, mid, end, depth+1);
+    nodes[index].first = (std::uint32_t)right;
+    nodes[index].count = 0;
+}
+
+void physics::mesh_collider::build(const std::vector<glm::vec3>& vertices, const std::vector<std::uint32_t>& indices, float f, bool ccd) {
+    clear();
+    friction = f;
+    continuous = ccd;
+    std::vector<mesh_triangle> tris;
+    std::vector<glm::vec3> centroids;
+    tris.reserve(indices.size()/3);
+    centroids.reserve(indices.size()/3);
+    for(size_type k=0; k+2<indices.size(); k+=3) {
+        mesh_triangle t;
+        t.a = vertices[indices[k]];
+        t.b = vertices[indices[k+1]];
+        t.c = vertices[indices[k+2]];
+        glm::vec3 n = cross(t.b - t.a, t.c - t.a);
+        float n_length = std::sqrt(dot(n, n));
+        if(!(n_length > 0.0f))
+            continue;
+        t.normal = n/n_length;
+        tris.push_back(t);
+        centroids.push_back((t.a + t.b + t.c)/3.0f);
+    }
+    if(tris.empty())
+        return;
+    // at most 2n-1 nodes for n triangles
+    nodes.reserve(2*tris.size());
+    nodes.push_back(mesh_bvh_node());
+    build_node(nodes, tris, centroids, 0, 0, tris.size(), 0);
+    triangles.assign(tris.begin(), tris.end());
+}
+
+void physics::mesh_collider::clear() {
+    nodes.clear();
+    triangles.clear();
+}
+
+
+
+/* ============================================================================ *
+ * Queries
+ * ============================================================================ */
+// closest point of triangle t to p (Ericson, Real-Time Collision Detection)
+static glm::vec3 closest_point(const physics::mesh_triangle& t, const glm::vec3& p) {
+    glm::vec3 ab = t.b - t.a;
+    glm::vec3 ac = t.c - t.a;
+    glm::vec3 ap = p - t.a;
+    float d1 = dot(ab, ap);
+    float d2 = dot(ac, ap);
+    if(d1 <= 0.0f && d2 <= 0.0f)
+        return t.a;
+    glm::vec3 bp = p - t.b;
+    float d3 = dot(ab, bp);
+    float d4 = dot(ac, bp);
+    if(d3 >= 0.0f && d4 <= d3)
+        return t.b;
+    float vc = d1*d4 - d3*d2;
+    if(vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        return t.a + ab*(d1/(d1 - d3));
+    glm::vec3 cp = p - t.c;
+    float d5 = dot(ab, cp);
+    float d6 = dot(ac, cp);
+    if(d6 >= 0.0f && d5 <= d6)
+        return t.c;
+    float vb = d5*d2 - d1*d6;
+    if(vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        return t.a + ac*(d2/(d2 - d6));
+    float va = d3*d6 - d5*d4;
+    if(va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+        return t.b + (t.c - t.b)*((d4 - d3)/((d4 - d3) + (d5 - d6)));
+    float denom = 1.0f/(va + vb + vc);
+    return t.a + ab*(vb*denom) + ac*(vc*denom);
+}
+
+// parameter of the crossing of segment o + d*[0, 1] with triangle t
+// (Moller-Trumbore), or a value > 1 if there is none
+static float segment_hit(const physics::mesh_triangle& t, const glm::vec3& o, const glm::vec3& d) {
+    const float miss = 2.0f;
+    glm::vec3 ab = t.b - t.a;
+    glm::vec3 ac = t.c - t.a;
+    glm::vec3 q = cross(d, ac);
+    float det = dot(ab, q);
+    if(std::abs(det) < 1e-12f)
+        return miss;
+    float inv_det = 1.0f/det;
+    glm::vec3 ao = o - t.a;
+    float u = dot(ao, q)*inv_det;
+    if(u < 0.0f || u > 1.0f)
+        return miss;
+    glm::vec3 r = cross(ao, ab);
+    float v = dot(d, r)*inv_det;
+    if(v < 0.0f || u + v > 1.0f)
+        return miss;
+    float s = dot(ac, r)*inv_det;
+    return s >= 0.0f && s <= 1.0f ? s : miss;
+}
+
+static bool overlaps(const physics::mesh_bvh_node& n, const glm::vec3& lo, const glm::vec3& hi) {
+    return n.lo.x <= hi.x && n.hi.x >= lo.x && n.lo.y <= hi.y && n.hi.y >= lo.y && n.lo.z <= hi.z && n.hi.z >= lo.z;
+}
+
+// where segment o + d*[0, 1] (with inv_d = 1/d per axis) enters the node's
+// bounds, or a value > 1 if it misses them (slab test)
+static float segment_entry(const physics::mesh_bvh_node& n, const glm::vec3& o, const glm::vec3& inv_d) {
+    float t0_x = (n.lo.x - o.x)*inv_d.x, t1_x = (n.hi.x - o.x)*inv_d.x;
+    float t0_y = (n.lo.y - o.y)*inv_d.y, t1_y = (n.hi.y - o.y)*inv_d.y;
+    float t0_z = (n.lo.z - o.z)*inv_d.z, t1_z = (n.hi.z - o.z)*inv_d.z;
+    float t_in = std::max(std::max(std::min(t0_x, t1_x), std::min(t0_y, t1_y)), std::max(std::min(t0_z, t1_z), 0.0f));
+    float t_out = std::min(std::min(std::max(t0_x, t1_x), std::max(t0_y, t1_y)), std::min(std::max(t0_z, t1_z), 1.0f));
+    return t_in <= t_out ? t_in : 2.0f;
+}
+
+static float safe_inverse(float x) {
+    return std::abs(x) > 1e-20f ? 1.0f/x : 1e20f;
+}
+
+// earliest crossing of the segment pos_old -> pos with the mesh, returns the
+// triangle (or nullptr) and its parameter in t_hit
+// - children are visited nearest first, and nodes entered after the
+//   earliest crossing so far are skipped
+static const physics::mesh_triangle* sweep_segment(const physics::mesh_collider& m, const glm::vec3& pos_old, const glm::vec3& path, float& t_hit) {
+    glm::vec3 inv_path(safe_inverse(path.x), safe_inverse(path.y), safe_inverse(path.z));
+    const physics::mesh_triangle* hit = nullptr;
+    t_hit = 2.0f;
+    if(segment_entry(m.nodes[0], pos_old, inv_path) > 1.0f)
+        return hit;
+    std::uint32_t stack[BVH_STACK_SIZE];
+    float stack_t[BVH_STACK_SIZE];
+    std::size_t top = 0;
+    stack[top] = 0;
+    stack_t[top++] = 0.0f;
+    while(top) {
+        top--;
+        if(stack_t[top] > t_hit)
+            continue;
+        const physics::mesh_bvh_node& n = m.nodes[stack[top]];
+        if(n.count == 0) {
+            std::uint32_t near = stack[top] + 1, far = n.first;
+            float t_near = segment_entry(m.nodes[near], pos_old, inv_path);
+            float t_far = segment_entry(m.nodes[far], pos_old, inv_path);
+            if(t_near > t_far) {
+                std::swap(near, far);
+                std::swap(t_near, t_far);
+            }
+            if(t_far <= 1.0f) {
+                stack[top] = far;
+                stack_t[top++] = t_far;
+            }
+            if(t_near <= 1.0f) {
+                stack[top] = near;
+                stack_t[top++] = t_near;
+            }
+            continue;
+        }
+        for(std::uint32_t k=n.first; k<n.first+n.count; k++) {
+            float s = segment_hit(m.triangles[k], pos_old, path);
+            if(s < t_hit) {
+                t_hit = s;
+                hit = &m.triangles[k];
+            }
+        }
+    }
+    return hit;
+}
+
+// nearest triangle to pos within margin (or nullptr) and its closest point
+// - children are tested before they are pushed, so both of their nodes are
+//   loaded together
+static const physics::mesh_triangle* nearest_triangle(const physics::mesh_collider& m, const glm::vec3& pos, float margin, glm::vec3& near_point) {
+    glm::vec3 lo = pos - glm::vec3(margin);
+    glm::vec3 hi = pos + glm::vec3(margin);
+    const physics::mesh_triangle* near = nullptr;
+    if(!overlaps(m.nodes[0], lo, hi))
+        return near;
+    float best_d_2 = margin*margin;
+    std::uint32_t stack[BVH_STACK_SIZE];
+    std::size_t top = 0;
+    stack[top++] = 0;
+    while(top) {
+        std::uint32_t i = stack[--top];
+        const physics::mesh_bvh_node& n = m.nodes[i];
+        if(n.count == 0) {
+            std::uint32_t left = i + 1, right = n.first;
+            bool hit_left = overlaps(m.nodes[left], lo, hi);
+            bool hit_right = overlaps(m.nodes[right], lo, hi);
+            if(hit_right)
+                stack[top++] = right;
+            if(hit_left)
+                stack[top++] = left;
+            continue;
+        }
+        for(std::uint32_t k=n.first; k<n.first+n.count; k++) {
+            // the plane is never farther than the closest point
+            const physics::mesh_triangle& t = m.triangles[k];
+            float plane_d = dot(pos - t.a, t.normal);
+            if(plane_d*plane_d >= best_d_2)
+                continue;
+            glm::vec3 q = closest_point(t, pos);
+            glm::vec3 d = pos - q;
+            float d_2 = dot(d, d);
+            if(d_2 < best_d_2) {
+                best_d_2 = d_2;
+                near = &t;
+                near_point = q;
+            }
+        }
+    }
+    return near;
+}
+
+// resolves one particle against the mesh, returns whether it was in contact
+static bool collide_particle(const physics::mesh_collider& m, glm::vec3& pos, const glm::vec3& pos_old, float margin) {
+    glm::vec3 path = pos - pos_old;
+    // a path shorter than the margin cannot cross the mesh without ending
+    // within the margin of it, so only longer ones are swept
+    if(m.continuous && dot(path, path) > margin*margin) {
+        float t_hit;
+        const physics::mesh_triangle* t = sweep_segment(m, pos_old, path, t_hit);
+        if(t) {
+            glm::vec3 surface = pos_old + path*t_hit;
+            glm::vec3 normal = dot(path, t->normal) > 0.0f ? -t->normal : t->normal;
+            physics::resolve_contact(pos, pos_old, surface + normal*margin, normal, m.friction);
+            return true;
+        }
+    }
+    glm::vec3 near_point(0);
+    const physics::mesh_triangle* t = nearest_triangle(m, pos, margin, near_point);
+    if(!t)
+        return false;
+    // out on the side the particle came from, unless it already started
+    // (about) on the surface, which means it slid or was pulled in and goes
+    // back out the front
+    float old_side = dot(pos_old - near_point, t->normal);
+    glm::vec3 normal = old_side < -0.5f*margin ? -t->normal : t->normal;
+    physics::resolve_contact(pos, pos_old, near_point + normal*margin, normal, m.friction);
+    return true;
+}
+
+std::size_t physics::resolve_mesh_collider(particle_set& p, const mesh_collider& m, const aligned_vector<particle_set::mask_word>& frozen, float margin, ThreadPool& pool) {
+    if(m.empty())
+        return 0;
+    std::atomic<std::size_t> count_resolved(0);
+    std::size_t num_particles = p.size();
+    pool.run([&](std::size_t thread, std::size_t num_threads) {
+        std::size_t count = 0;
+        for(std::size_t i=num_particles*thread/num_threads; i<num_particles*(thread+1)/num_threads; i++) {
+            std::size_t w = i/particle_set::MASK_WORD_BITS;
+            particle_set::mask_word stuck = p.pinned[w] | (w < frozen.size() ? frozen[w] : 0);
+            if((stuck >> (i%particle_set::MASK_WORD_BITS)) & 1u)
+                continue;
+            if(collide_particle(m, p.pos[i], p.pos_old[i], margin))
+                count++;
+        }
+        count_resolved.fetch_add(count, std::memory_order_relaxed);
+    });
+    return count_resolved.load();
+}
@@ -0,0 +1,91 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: mesh_collider.h
+ *  Header file for the static triangle mesh collider and its bounding
+ *  volume hierarchy
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: The hierarchy is built top down with the surface area heuristic,
+ *  binning triangle centroids into MESH_BVH_BINS bins along each axis, and
+ *  stored depth first: an inner node's left child directly follows it, and
+ *  the triangles are reordered so every leaf owns a contiguous range.
+ *  Every free particle queries the hierarchy on its own, so the particles
+ *  are split across the pool and the result does not depend on the thread
+ *  count. A particle within the margin of the mesh is pushed out to it, on
+ *  the side its pos_old is on, so particles that crossed a thin shell during
+ *  the substep are pushed back rather than through; one that started about
+ *  on the surface goes out the front, which is the side the triangles wind
+ *  counterclockwise on (outwards for a closed mesh). A discrete pass only
+ *  catches particles that move less than the margin per substep. With
+ *  continuous collision, a path pos_old -> pos (the motion of the last
+ *  substep) longer than the margin is swept through the hierarchy first,
+ *  nearest node first, and a crossing stops the particle at the margin
+ *  before its earliest hit, so fast particles cannot tunnel through.
+ *  Contacts keep `friction` of their tangential motion, like the other
+ *  colliders (see resolve_contact()).
+ * ---------------------------------------------------------------------------- */
+
+#ifndef MESH_COLLIDER_H
+#define MESH_COLLIDER_H
+
+#include "../../lib/glm/vec3.hpp"
+
+#include "particles.h"
+#include "aligned_allocator.h"
+#include "thread_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace physics {
+    // static constants
+    const std::size_t MESH_BVH_BINS = 16;
+    const std::size_t MESH_BVH_LEAF_SIZE = 4;
+
+    struct mesh_bvh_node {
+        glm::vec3 lo;
+        std::uint32_t first; // leaf: first triangle, inner: right child
+        glm::vec3 hi;
+        std::uint32_t count; // triangles of a leaf, 0 for inner nodes
+    };
+
+    struct mesh_triangle {
+        glm::vec3 a;
+        glm::vec3 b;
+        glm::vec3 c;
+        glm::vec3 normal;
+    };
+
+    struct mesh_collider {
+        // typedefs
+        typedef std::size_t size_type;
+
+        std::vector<mesh_bvh_node> nodes;
+        // - in leaf order
+        aligned_vector<mesh_triangle> triangles;
+        float friction;
+        bool continuous;
+
+        // container properties
+        bool empty() const;
+
+        // container manipulation
+        // - three indices into vertices per triangle, degenerate triangles
+        //   are dropped
+        void build(const std::vector<glm::vec3>& vertices, const std::vector<std::uint32_t>& indices, float friction, bool continuous);
+        void clear();
+    };
+
+    // - pushes every particle not set in `frozen` (same layout as
+    //   particle_set::pinned, may be empty) out of the mesh, to margin from
+    //   its surface
+    // - returns the number of contacts that were resolved
+    std::size_t resolve_mesh_collider(particle_set& p, const mesh_collider& m, const aligned_vector<particle_set::mask_word>& frozen, float margin, ThreadPool& pool);
+}
+
+#endif
@@ -0,0 +1,171 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: multigrid.cpp
+ *  Definition file for the geometric multigrid hierarchy of the cloth grid
+ * **************************************************************************** */
+
+#include "multigrid.h"
+
+#include "constraint_kernel.h"
+#include "islands.h"
+
+#include <algorithm>
+
+namespace {
+    bool is_set(const physics::aligned_vector<physics::particle_set::mask_word>& mask, std::size_t i) {
+        std::size_t w = i/physics::particle_set::MASK_WORD_BITS;
+        return w < mask.size() && ((mask[w] >> (i%physics::particle_set::MASK_WORD_BITS)) & 1u);
+    }
+
+    // grid directions of the edges kept per level
+    enum GridDirection {
+        Right=0,
+        Down,
+        DiagDownRight,
+        DiagDownLeft,
+        DirectionCount
+    };
+    const int DIR_DR[DirectionCount] = {0, 1, 1, 1};
+    const int DIR_DC[DirectionCount] = {1, 0, 1, -1};
+}
+
+/* ============================================================================ *
+ * Hierarchy
+ * ============================================================================ */
+void physics::multigrid_hierarchy::clear() {
+    n = 0;
+    levels.clear();
+    component.clear();
+}
+
+void physics::multigrid_hierarchy::build(size_type n, const std::vector<distance_constraint>& edges, const aligned_vector<particle_set::mask_word>& asleep, size_type min_side, float flex_coeff) {
+    clear();
+    this->n = n;
+    // connected components over every edge, not just the grid ones
+    disjoint_sets sets;
+    sets.reset(n*n);
+    for(auto it=edges.begin(); it!=edges.end(); ++it)
+        sets.unite(it->a, it->b);
+    component.resize(n*n);
+    for(size_type i=0; i<n*n; i++)
+        component[i] = sets.find(i);
+    // rest length of the edge leaving each grid vertex in each direction at
+    // the current stride, negative where there is none
+    std::vector<float> length[DirectionCount];
+    for(int d=0; d<DirectionCount; d++)
+        length[d].assign(n*n, -1.0f);
+    for(auto it=edges.begin(); it!=edges.end(); ++it) {
+        int dr = (int)(it->b/n) - (int)(it->a/n);
+        int dc = (int)(it->b%n) - (int)(it->a%n);
+        for(int d=0; d<DirectionCount; d++) {
+            if(dr == DIR_DR[d] && dc == DIR_DC[d])
+                length[d][it->a] = it->rest_length;
+        }
+    }
+    for(size_type stride=2; (n-1)/stride+1 >= min_side; stride*=2) {
+        // chain two edges of the previous stride into one of this stride
+        size_type half = stride/2;
+        std::vector<float> next[DirectionCount];
+        for(int d=0; d<DirectionCount; d++) {
+            next[d].assign(n*n, -1.0f);
+            for(size_type r=0; r<n; r+=stride) {
+                for(size_type c=0; c<n; c+=stride) {
+                    int r2 = (int)r + DIR_DR[d]*(int)half;
+                    int c2 = (int)c + DIR_DC[d]*(int)half;
+                    if(r2 >= (int)n || c2 < 0 || c2 >= (int)n)
+                        continue;
+                    float first = length[d][r*n+c];
+                    float second = length[d][r2*n+c2];
+                    if(first >= 0 && second >= 0)
+                        next[d][r*n+c] = first + second;
+                }
+            }
+            length[d].swap(next[d]);
+        }
+
+        grid_level level;
+        level.stride = stride;
+        level.side = (n-1)/stride+1;
+        std::vector<distance_constraint> constraints;
+        for(size_type r=0; r<n; r+=stride) {
+            for(size_type c=0; c<n; c+=stride) {
+                for(int d=0; d<DirectionCount; d++) {
+                    float l = length[d][r*n+c];
+                    if(l < 0)
+                        continue;
+                    size_type b = (r + DIR_DR[d]*stride)*n + (c + DIR_DC[d]*stride);
+                    // both ends are in the same island, so asleep together
+                    bool disabled = is_set(asleep, r*n+c);
+                    constraints.push_back({r*n+c, b, l, flex_coeff, 0.0f, 0, 0.0f, disabled});
+                }
+            }
+        }
+        level.constraints.build(constraints, n*n);
+        // unilateral, padding keeps its negative lower bound
+        for(auto it=level.constraints.lower_sq.begin(); it!=level.constraints.lower_sq.end(); ++it)
+            *it = std::min(*it, 0.0f);
+        level.pos_start.resize(level.side*level.side);
+        levels.push_back(std::move(level));
+    }
+}
+
+
+
+/* ============================================================================ *
+ * Solving
+ * ============================================================================ */
+std::size_t physics::solve_multigrid(particle_set& p, multigrid_hierarchy& h, const aligned_vector<particle_set::mask_word>& asleep, std::size_t iterations) {
+    std::size_t count_resolved = 0;
+    std::size_t n = h.n;
+    for(auto level=h.levels.rbegin(); level!=h.levels.rend(); ++level) {
+        std::size_t s = level->stride;
+        std::size_t side = level->side;
+        for(std::size_t r=0; r<side; r++) {
+            for(std::size_t c=0; c<side; c++)
+                level->pos_start[r*side+c] = p.pos[(r*s)*n + c*s];
+        }
+        for(std::size_t i=0; i<iterations; i++)
+            count_resolved += solve_constraints(p, level->constraints, nullptr, 0, level->constraints.size());
+        // the start positions become the level's displacements
+        for(std::size_t r=0; r<side; r++) {
+            for(std::size_t c=0; c<side; c++)
+                level->pos_start[r*side+c] = p.pos[(r*s)*n + c*s] - level->pos_start[r*side+c];
+        }
+        const aligned_vector<glm::vec3>& delta = level->pos_start;
+        const std::vector<std::int32_t>& component = h.component;
+        // bilinear prolongation, rows and columns past the last coarse one
+        // take the displacement of their nearest coarse vertex
+        // - corners in another component than the particle are dropped and
+        //   the rest reweighted, a particle with none keeps its position
+        for(std::size_t r=0; r<n; r++) {
+            std::size_t r0 = r/s;
+            std::size_t r1 = std::min(r0+1, side-1);
+            float wr = r0 == r1 ? 0.0f : (float)(r - r0*s)/s;
+            for(std::size_t c=0; c<n; c++) {
+                std::size_t i = r*n + c;
+                if(p.is_pinned(i) || (r%s == 0 && c%s == 0) || is_set(asleep, i))
+                    continue;
+                std::size_t c0 = c/s;
+                std::size_t c1 = std::min(c0+1, side-1);
+                float wc = c0 == c1 ? 0.0f : (float)(c - c0*s)/s;
+                std::size_t corner[4] = {r0*side+c0, r0*side+c1, r1*side+c0, r1*side+c1};
+                std::size_t corner_fine[4] = {(r0*s)*n + c0*s, (r0*s)*n + c1*s, (r1*s)*n + c0*s, (r1*s)*n + c1*s};
+                float weight[4] = {(1.0f-wr)*(1.0f-wc), (1.0f-wr)*wc, wr*(1.0f-wc), wr*wc};
+                glm::vec3 sum(0.0f);
+                float weight_sum = 0.0f;
+                for(int k=0; k<4; k++) {
+                    if(weight[k] > 0.0f && component[corner_fine[k]] == component[i]) {
+                        sum += weight[k]*delta[corner[k]];
+                        weight_sum += weight[k];
+                    }
+                }
+                if(weight_sum > 0.0f)
+                    p.pos[i] += sum/weight_sum;
+            }
+        }
+    }
+    return count_resolved;
+}
@@ -0,0 +1,83 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: multigrid.h
+ *  Header file for the geometric multigrid hierarchy of the cloth grid
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: Level k of the hierarchy is the subset of the n x n particle grid
+ *  whose row and column are multiples of stride = 2^k, connected by
+ *  horizontal, vertical and diagonal constraints spanning one coarse cell.
+ *  A coarse constraint only exists while every fine edge along its path is
+ *  intact, and its rest length is the sum of theirs. Coarse levels work on
+ *  the fine particles directly (the coarse particles ARE fine particles), so
+ *  pins need no restriction and the regular kernels apply.
+ *  Coarse constraints are unilateral: they only resist stretching, since a
+ *  coarse cell may legitimately shrink when the fine cloth folds or bends.
+ *  The levels are solved coarsest first; after each one the displacement of
+ *  its particles is prolongated to every other particle by bilinear
+ *  interpolation over the coarse cell containing it, from only the corners
+ *  still connected to it over the fine edges (weights renormalized), so a
+ *  torn-off scrap never follows the piece it used to hang next to. Asleep
+ *  particles get no coarse constraints and no prolongation. Long-wavelength
+ *  stretch is thereby removed in a few coarse sweeps, and the fine sweeps
+ *  only need to resolve the local error.
+ * ---------------------------------------------------------------------------- */
+
+#ifndef MULTIGRID_H
+#define MULTIGRID_H
+
+#include "../../lib/glm/vec3.hpp"
+
+#include "particles.h"
+#include "constraints.h"
+#include "aligned_allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace physics {
+    struct grid_level {
+        // typedefs
+        typedef std::size_t size_type;
+
+        size_type stride; // fine grid cells per coarse cell
+        size_type side;   // coarse vertices per side
+        constraint_set constraints;
+        // - level particle positions before the level was solved, indexed by
+        //   coarse row * side + coarse column
+        aligned_vector<glm::vec3> pos_start;
+    };
+
+    struct multigrid_hierarchy {
+        // typedefs
+        typedef std::size_t size_type;
+
+        size_type n; // fine side vertex count
+        std::vector<grid_level> levels; // finest (stride 2) first
+        // - connected component of every fine particle over the fine edges,
+        //   a representative particle of it
+        std::vector<std::int32_t> component;
+
+        void clear();
+        // - builds every level with at least min_side vertices per side from
+        //   the fine edges of an n x n grid (constraints between grid
+        //   neighbors, other edges are ignored), coarse constraints may
+        //   stretch by flex_coeff
+        // - coarse constraints of particles set in `asleep` (same layout as
+        //   particle_set::pinned) get no slot, rebuild when it changes
+        void build(size_type n, const std::vector<distance_constraint>& edges, const aligned_vector<particle_set::mask_word>& asleep, size_type min_side, float flex_coeff);
+    };
+
+    // - solves the levels coarsest first, `iterations` sweeps each, and
+    //   prolongates each level's correction to every particle neither
+    //   pinned nor set in `asleep`
+    // - returns the number of constraints resolved
+    std::size_t solve_multigrid(particle_set& p, multigrid_hierarchy& h, const aligned_vector<particle_set::mask_word>& asleep, std::size_t iterations);
+}
+
+#endif
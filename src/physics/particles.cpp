@@ -0,0 +1,52 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: particles.cpp
+ *  Definition file for the solver-side particle storage
+ * **************************************************************************** */
+
+#include "particles.h"
+
+/* ============================================================================ *
+ * Container Manipulation
+ * ============================================================================ */
+void physics::particle_set::clear() {
+    pos.clear();
+    pos_old.clear();
+    inv_mass.clear();
+    pinned.clear();
+}
+
+void physics::particle_set::reserve(size_type n) {
+    pos.reserve(n);
+    pos_old.reserve(n);
+    inv_mass.reserve(n);
+    pinned.reserve((n + MASK_WORD_BITS - 1)/MASK_WORD_BITS);
+}
+
+physics::particle_set::size_type physics::particle_set::push_back(const glm::vec3& p, float inverse_mass) {
+    size_type index = pos.size();
+    pos.push_back(p);
+    pos_old.push_back(p);
+    inv_mass.push_back(inverse_mass);
+    // new mask words start fully pinned so padding bits are never integrated
+    if(index % MASK_WORD_BITS == 0)
+        pinned.push_back(~mask_word(0));
+    set_pinned(index, false);
+    return index;
+}
+
+
+
+/* ============================================================================ *
+ * Pinned Bitmask
+ * ============================================================================ */
+void physics::particle_set::set_pinned(size_type i, bool p) {
+    mask_word bit = mask_word(1) << (i%MASK_WORD_BITS);
+    if(p)
+        pinned[i/MASK_WORD_BITS] |= bit;
+    else
+        pinned[i/MASK_WORD_BITS] &= ~bit;
+}
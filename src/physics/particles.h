@@ -0,0 +1,74 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: particles.h
+ *  Header file for the solver-side particle storage (structure of arrays)
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: Only the state read by the integrator and the constraint solver lives
+ *  here. Topology (edge slots, adjacency) and render data (normals, uvs) stay
+ *  with the owner of the particle set, so the hot loops stream nothing else.
+ * ---------------------------------------------------------------------------- */
+
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include "../../lib/glm/vec3.hpp"
+
+#include "aligned_allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace physics {
+    struct particle_set {
+        // typedefs
+        typedef std::size_t size_type;
+        typedef std::uint32_t mask_word;
+
+        // static constants
+        static const size_type MASK_WORD_BITS = 32;
+
+        // solver arrays (all indexed by particle)
+        aligned_vector<glm::vec3> pos;
+        aligned_vector<glm::vec3> pos_old;
+        aligned_vector<float> inv_mass;
+        // - one bit per particle, padding bits past size() are always set
+        aligned_vector<mask_word> pinned;
+
+        // container properties
+        size_type size() const;
+        bool empty() const;
+
+        // container manipulation
+        void clear();
+        void reserve(size_type n);
+        size_type push_back(const glm::vec3& p, float inverse_mass);
+
+        // pinned bitmask
+        bool is_pinned(size_type i) const;
+        void set_pinned(size_type i, bool p);
+
+        // inverse mass as seen by the constraints (0 for pinned particles)
+        float weight(size_type i) const;
+    };
+
+    // inline accessors (used by the inner solver loops)
+    inline particle_set::size_type particle_set::size() const {
+        return pos.size();
+    }
+    inline bool particle_set::empty() const {
+        return pos.empty();
+    }
+    inline bool particle_set::is_pinned(size_type i) const {
+        return (pinned[i/MASK_WORD_BITS] >> (i%MASK_WORD_BITS)) & 1u;
+    }
+    inline float particle_set::weight(size_type i) const {
+        return is_pinned(i) ? 0.0f : inv_mass[i];
+    }
+}
+
+#endif
@@ -0,0 +1,268 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: picking.cpp
+ *  Definition file for the bounding hierarchy used to pick particles with a
+ *  ray
+ * **************************************************************************** */
+
+#include "picking.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// a walk holds at most PICK_BRANCHING nodes per level, and levels above
+// 2^32 particles never occur
+static const std::size_t PICK_STACK_SIZE = 128;
+
+static float dot(const glm::vec3& a, const glm::vec3& b) {
+    return a.x*b.x + a.y*b.y + a.z*b.z;
+}
+
+static bool is_excluded(const physics::aligned_vector<physics::particle_set::mask_word>& excluded, std::size_t i) {
+    std::size_t w = i/physics::particle_set::MASK_WORD_BITS;
+    return w < excluded.size() && ((excluded[w] >> (i%physics::particle_set::MASK_WORD_BITS)) & 1u);
+}
+
+
+
+/* ============================================================================ *
+ * Container Properties
+ * ============================================================================ */
+bool physics::pick_hierarchy::empty() const {
+    return lo.empty();
+}
+
+
+
+/* ============================================================================ *
+ * Container Manipulation
+ * ============================================================================ */
+void physics::pick_hierarchy::clear() {
+    lo.clear();
+    hi.clear();
+    level_begin.clear();
+    num_particles = 0;
+}
+
+void physics::pick_hierarchy::refit(const particle_set& p, const aligned_vector<particle_set::mask_word>& excluded, ThreadPool& pool) {
+    if(p.empty()) {
+        clear();
+        return;
+    }
+    if(lo.empty() || num_particles != p.size()) {
+        num_particles = p.size();
+        level_begin.assign(1, 0);
+        size_type count = (num_particles + PICK_LEAF_SIZE - 1)/PICK_LEAF_SIZE;
+        size_type total = 0;
+        while(true) {
+            total += count;
+            level_begin.push_back(total);
+            if(count == 1)
+                break;
+            count = (count + PICK_BRANCHING - 1)/PICK_BRANCHING;
+        }
+        lo.resize(total);
+        hi.resize(total);
+    }
+    const float infinity = std::numeric_limits<float>::infinity();
+    // leaves, split across the pool
+    // - a leaf is one word of the excluded mask
+    size_type num_leaves = level_begin[1];
+    pool.run([&](std::size_t thread, std::size_t num_threads) {
+        for(size_type l=num_leaves*thread/num_threads; l<num_leaves*(thread+1)/num_threads; l++) {
+            size_type first = l*PICK_LEAF_SIZE;
+            size_type count = std::min(num_particles - first, PICK_LEAF_SIZE);
+            particle_set::mask_word live = l < excluded.size() ? ~excluded[l] : ~(particle_set::mask_word)0;
+            if(count < PICK_LEAF_SIZE)
+                live &= ((particle_set::mask_word)1 << count) - 1;
+            float lo_x = infinity, lo_y = infinity, lo_z = infinity;
+            float hi_x = -infinity, hi_y = -infinity, hi_z = -infinity;
+            while(live) {
+                const glm::vec3& pos = p.pos[first + __builtin_ctz(live)];
+                live &= live - 1;
+                lo_x = std::min(lo_x, pos.x);
+                lo_y = std::min(lo_y, pos.y);
+                lo_z = std::min(lo_z, pos.z);
+                hi_x = std::max(hi_x, pos.x);
+                hi_y = std::max(hi_y, pos.y);
+                hi_z = std::max(hi_z, pos.z);
+            }
+            lo[l] = glm::vec3(lo_x, lo_y, lo_z);
+            hi[l] = glm::vec3(hi_x, hi_y, hi_z);
+        }
+    });
+    // upper levels, an eighth of the nodes below each
+    for(size_type level=1; level+1<level_begin.size(); level++) {
+        size_type below = level_begin[level-1];
+        size_type below_end = level_begin[level];
+        for(size_type k=level_begin[level]; k<level_begin[level+1]; k++) {
+            glm::vec3 node_lo(infinity);
+            glm::vec3 node_hi(-infinity);
+            size_type first = below + (k - level_begin[level])*PICK_BRANCHING;
+            size_type end = std::min(below_end, first + PICK_BRANCHING);
+            for(size_type c=first; c<end; c++) {
+                node_lo = glm::vec3(std::min(node_lo.x, lo[c].x), std::min(node_lo.y, lo[c].y), std::min(node_lo.z, lo[c].z));
+                node_hi = glm::vec3(std::max(node_hi.x, hi[c].x), std::max(node_hi.y, hi[c].y), std::max(node_hi.z, hi[c].z));
+            }
+            lo[k] = node_lo;
+            hi[k] = node_hi;
+        }
+    }
+}
+
+
+
+/* ============================================================================ *
+ * Lookup
+ * ============================================================================ */
+// where the ray o + t*d (with inv_d = 1/d per axis) enters the box inflated
+// by radius within [0, t_max], or infinity if it does not (slab test)
+static float box_entry(const glm::vec3& lo, const glm::vec3& hi, const glm::vec3& o, const glm::vec3& inv_d, float radius, float t_max) {
+    if(!(lo.x <= hi.x))
+        return std::numeric_limits<float>::infinity();
+    float t0_x = (lo.x - radius - o.x)*inv_d.x, t1_x = (hi.x + radius - o.x)*inv_d.x;
+    float t0_y = (lo.y - radius - o.y)*inv_d.y, t1_y = (hi.y + radius - o.y)*inv_d.y;
+    float t0_z = (lo.z - radius - o.z)*inv_d.z, t1_z = (hi.z + radius - o.z)*inv_d.z;
+    float t_in = std::max(std::max(std::min(t0_x, t1_x), std::min(t0_y, t1_y)), std::max(std::min(t0_z, t1_z), 0.0f));
+    float t_out = std::min(std::min(std::max(t0_x, t1_x), std::max(t0_y, t1_y)), std::min(std::max(t0_z, t1_z), t_max));
+    return t_in <= t_out ? t_in : std::numeric_limits<float>::infinity();
+}
+
+// nearest t >= 0 where the ray o + t*d (d of unit length) hits the sphere,
+// or a negative value
+// - measured from the ray's closest approach to the center rather than by
+//   the quadratic's discriminant, which cancels away for small spheres far
+//   from the origin
+static float sphere_hit(const glm::vec3& center, float radius, const glm::vec3& o, const glm::vec3& d) {
+    float t_closest = dot(center - o, d);
+    glm::vec3 h = o + d*t_closest - center;
+    float h_2 = dot(h, h);
+    float r_2 = radius*radius;
+    if(h_2 > r_2)
+        return -1.0f;
+    float s = std::sqrt(r_2 - h_2);
+    float t = t_closest - s;
+    return t >= 0.0f ? t : t_closest + s;
+}
+
+static float safe_inverse(float x) {
+    return std::abs(x) > 1e-20f ? 1.0f/x : 1e20f;
+}
+
+bool physics::pick_hierarchy::pick(const particle_set& p, const aligned_vector<particle_set::mask_word>& excluded, const glm::vec3& origin, const glm::vec3& dir, float radius, size_type& index, float& t) const {
+    float dir_length = std::sqrt(dot(dir, dir));
+    if(lo.empty() || num_particles != p.size() || !(dir_length > 0.0f))
+        return false;
+    // walks in units of length, t is scaled back at the end
+    glm::vec3 d = dir/dir_length;
+    glm::vec3 inv_dir(safe_inverse(d.x), safe_inverse(d.y), safe_inverse(d.z));
+    float best_t = std::numeric_limits<float>::infinity();
+    bool found = false;
+    // (level, node) pairs with the t the ray enters the node at
+    size_type stack_level[PICK_STACK_SIZE];
+    size_type stack_node[PICK_STACK_SIZE];
+    float stack_t[PICK_STACK_SIZE];
+    size_type top = 0;
+    size_type root = level_begin[level_begin.size()-2];
+    float root_t = box_entry(lo[root], hi[root], origin, inv_dir, radius, best_t);
+    if(root_t == std::numeric_limits<float>::infinity())
+        return false;
+    stack_level[top] = level_begin.size() - 2;
+    stack_node[top] = root;
+    stack_t[top++] = root_t;
+    while(top) {
+        top--;
+        if(stack_t[top] > best_t)
+            continue;
+        size_type level = stack_level[top];
+        size_type k = stack_node[top] - level_begin[level];
+        if(level == 0) {
+            size_type end = std::min(num_particles, (k + 1)*PICK_LEAF_SIZE);
+            for(size_type i=k*PICK_LEAF_SIZE; i<end; i++) {
+                if(is_excluded(excluded, i))
+                    continue;
+                float s = sphere_hit(p.pos[i], radius, origin, d);
+                if(s >= 0.0f && s < best_t) {
+                    best_t = s;
+                    index = i;
+                    found = true;
+                }
+            }
+            continue;
+        }
+        // children entered within the nearest hit so far, farthest pushed
+        // first so the nearest is walked first
+        size_type first = level_begin[level-1] + k*PICK_BRANCHING;
+        size_type end = std::min(level_begin[level], first + PICK_BRANCHING);
+        size_type base = top;
+        for(size_type c=first; c<end; c++) {
+            float s = box_entry(lo[c], hi[c], origin, inv_dir, radius, best_t);
+            if(s == std::numeric_limits<float>::infinity())
+                continue;
+            // insertion by descending t
+            size_type j = top++;
+            while(j > base && stack_t[j-1] < s) {
+                stack_level[j] = stack_level[j-1];
+                stack_node[j] = stack_node[j-1];
+                stack_t[j] = stack_t[j-1];
+                j--;
+            }
+            stack_level[j] = level - 1;
+            stack_node[j] = c;
+            stack_t[j] = s;
+        }
+    }
+    if(found)
+        t = best_t/dir_length;
+    return found;
+}
+
+physics::pick_hierarchy::size_type physics::pick_hierarchy::query_sphere(const particle_set& p, const aligned_vector<particle_set::mask_word>& excluded, const glm::vec3& center, float radius, std::vector<size_type>& out) const {
+    if(lo.empty() || num_particles != p.size())
+        return 0;
+    size_type before = out.size();
+    float radius_2 = radius*radius;
+    // (level, node) pairs
+    size_type stack_level[PICK_STACK_SIZE];
+    size_type stack_node[PICK_STACK_SIZE];
+    size_type top = 0;
+    stack_level[top] = level_begin.size() - 2;
+    stack_node[top++] = level_begin[level_begin.size()-2];
+    while(top) {
+        top--;
+        size_type level = stack_level[top];
+        size_type node = stack_node[top];
+        // squared distance from the center to the node's bounds
+        const glm::vec3& node_lo = lo[node];
+        const glm::vec3& node_hi = hi[node];
+        if(!(node_lo.x <= node_hi.x))
+            continue;
+        glm::vec3 gap(std::max(std::max(node_lo.x - center.x, center.x - node_hi.x), 0.0f),
+                      std::max(std::max(node_lo.y - center.y, center.y - node_hi.y), 0.0f),
+                      std::max(std::max(node_lo.z - center.z, center.z - node_hi.z), 0.0f));
+        if(dot(gap, gap) > radius_2)
+            continue;
+        size_type k = node - level_begin[level];
+        if(level == 0) {
+            size_type end = std::min(num_particles, (k + 1)*PICK_LEAF_SIZE);
+            for(size_type i=k*PICK_LEAF_SIZE; i<end; i++) {
+                glm::vec3 d = p.pos[i] - center;
+                if(dot(d, d) <= radius_2 && !is_excluded(excluded, i))
+                    out.push_back(i);
+            }
+            continue;
+        }
+        // children pushed last to first, so they come out ascending
+        size_type first = level_begin[level-1] + k*PICK_BRANCHING;
+        size_type end = std::min(level_begin[level], first + PICK_BRANCHING);
+        for(size_type c=end; c-->first; ) {
+            stack_level[top] = level - 1;
+            stack_node[top++] = c;
+        }
+    }
+    return out.size() - before;
+}
@@ -0,0 +1,78 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: picking.h
+ *  Header file for the bounding hierarchy used to pick particles with a ray
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: The hierarchy never changes shape, only its bounds are refit: a leaf
+ *  bounds PICK_LEAF_SIZE consecutive particles, and every node above bounds
+ *  PICK_BRANCHING consecutive nodes of the level below, up to a single root.
+ *  Particles are laid out row by row over the cloth grid and neighbors are
+ *  held together by edges, so a leaf stays a short strip of cloth however
+ *  it drapes; a torn scrap flying off only widens the boxes it is in.
+ *  A refit is one pass over the particles (split across the pool) plus the
+ *  small upper levels, and a pick walks only the nodes its ray passes
+ *  through, skipping those entered beyond the nearest hit so far. Rays are
+ *  given in model space, so the caller transforms one ray instead of every
+ *  particle. A sphere query (for brushes) walks the nodes its sphere
+ *  touches, so it costs about the particles inside plus the walk down.
+ * ---------------------------------------------------------------------------- */
+
+#ifndef PICKING_H
+#define PICKING_H
+
+#include "../../lib/glm/vec3.hpp"
+
+#include "particles.h"
+#include "aligned_allocator.h"
+#include "thread_pool.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace physics {
+    // static constants
+    // - one word of a particle mask
+    const std::size_t PICK_LEAF_SIZE = particle_set::MASK_WORD_BITS;
+    const std::size_t PICK_BRANCHING = 8;
+
+    struct pick_hierarchy {
+        // typedefs
+        typedef std::size_t size_type;
+
+        // bounds of every node, level by level from the leaves up, the nodes
+        // of level l are [level_begin[l], level_begin[l+1]), an empty node
+        // has lo > hi
+        aligned_vector<glm::vec3> lo;
+        aligned_vector<glm::vec3> hi;
+        std::vector<size_type> level_begin;
+        size_type num_particles;
+
+        // container properties
+        bool empty() const;
+
+        // container manipulation
+        void clear();
+        // - rebuilds the levels if the particle count changed, then bounds
+        //   every particle not set in `excluded` (same layout as
+        //   particle_set::pinned) at its current position
+        void refit(const particle_set& p, const aligned_vector<particle_set::mask_word>& excluded, ThreadPool& pool);
+
+        // lookup
+        // - nearest particle not set in `excluded` whose sphere of `radius`
+        //   the ray origin + t*dir (t >= 0) hits, the particles must not
+        //   have moved since the last refit
+        // - returns whether there was one, and its index and t
+        bool pick(const particle_set& p, const aligned_vector<particle_set::mask_word>& excluded, const glm::vec3& origin, const glm::vec3& dir, float radius, size_type& index, float& t) const;
+        // - appends every particle not set in `excluded` within radius of
+        //   center to out, ascending, same requirement as pick()
+        // - returns the number appended
+        size_type query_sphere(const particle_set& p, const aligned_vector<particle_set::mask_word>& excluded, const glm::vec3& center, float radius, std::vector<size_type>& out) const;
+    };
+}
+
+#endif
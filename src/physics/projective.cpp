@@ -0,0 +1,468 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: projective.cpp
+ *  Definition file for the Projective Dynamics integrator
+ * **************************************************************************** */
+
+#include "projective.h"
+
+#include "../../lib/glm/glm.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <new>
+
+/* ============================================================================ *
+ * Ordering
+ * ============================================================================ */
+// parts of at most this many vertices are not split further
+static const std::size_t DISSECTION_LEAF = 64;
+
+// breadth-first levels of the part marked `stamp` from `root`, returns the
+// level count; order holds the reached vertices level by level, level_begin
+// where each level starts
+static std::size_t bfs_levels(std::int32_t root, std::size_t stamp, const std::vector<std::size_t>& adj_begin, const std::vector<std::int32_t>& adj, const std::vector<std::size_t>& mark, std::vector<std::int32_t>& level, std::vector<std::int32_t>& order, std::vector<std::size_t>& level_begin) {
+    order.clear();
+    level_begin.clear();
+    order.push_back(root);
+    level[root] = 0;
+    std::size_t head = 0;
+    while(head < order.size()) {
+        level_begin.push_back(head);
+        std::size_t end = order.size();
+        std::int32_t next = (std::int32_t)level_begin.size();
+        for(; head<end; head++) {
+            std::int32_t v = order[head];
+            for(std::size_t k=adj_begin[v]; k<adj_begin[v+1]; k++) {
+                std::int32_t u = adj[k];
+                if(mark[u] == stamp && level[u] < 0) {
+                    level[u] = next;
+                    order.push_back(u);
+                }
+            }
+        }
+    }
+    level_begin.push_back(order.size());
+    return level_begin.size()-1;
+}
+
+// nested dissection, iterative over a stack of parts that each own a range
+// of the order
+static void nested_dissection(std::size_t size, const std::vector<std::size_t>& adj_begin, const std::vector<std::int32_t>& adj, std::vector<std::int32_t>& perm) {
+    struct part {
+        std::vector<std::int32_t> vertices;
+        std::size_t first; // position of its first vertex in perm
+    };
+    perm.resize(size);
+    std::vector<std::size_t> mark(size, 0);
+    std::vector<std::int32_t> level(size, -1);
+    std::vector<std::int32_t> order;
+    std::vector<std::size_t> level_begin;
+    std::size_t stamp = 0;
+
+    std::vector<part> stack(1);
+    stack[0].first = 0;
+    for(std::size_t v=0; v<size; v++)
+        stack[0].vertices.push_back((std::int32_t)v);
+    while(!stack.empty()) {
+        part pt;
+        pt.vertices.swap(stack.back().vertices);
+        pt.first = stack.back().first;
+        stack.pop_back();
+        if(pt.vertices.size() <= DISSECTION_LEAF) {
+            std::copy(pt.vertices.begin(), pt.vertices.end(), perm.begin() + pt.first);
+            continue;
+        }
+        stamp++;
+        for(auto it=pt.vertices.begin(); it!=pt.vertices.end(); ++it)
+            mark[*it] = stamp;
+
+        // pseudo-peripheral root, restart from the least connected vertex of
+        // the last level while that deepens the levels
+        std::size_t num_levels = bfs_levels(pt.vertices[0], stamp, adj_begin, adj, mark, level, order, level_begin);
+        for(int tries=0; tries<3; tries++) {
+            std::int32_t far = order[level_begin[num_levels-1]];
+            for(std::size_t k=level_begin[num_levels-1]; k<level_begin[num_levels]; k++) {
+                if(adj_begin[order[k]+1] - adj_begin[order[k]] < adj_begin[far+1] - adj_begin[far])
+                    far = order[k];
+            }
+            for(auto it=order.begin(); it!=order.end(); ++it)
+                level[*it] = -1;
+            std::size_t l = bfs_levels(far, stamp, adj_begin, adj, mark, level, order, level_begin);
+            if(l <= num_levels)
+                break;
+            num_levels = l;
+        }
+        num_levels = level_begin.size()-1;
+
+        // not connected, the reached component and the rest are ordered apart
+        if(order.size() < pt.vertices.size()) {
+            part rest;
+            rest.first = pt.first + order.size();
+            for(auto it=pt.vertices.begin(); it!=pt.vertices.end(); ++it) {
+                if(level[*it] < 0)
+                    rest.vertices.push_back(*it);
+            }
+            for(auto it=order.begin(); it!=order.end(); ++it)
+                level[*it] = -1;
+            stack.push_back(part());
+            stack.back().vertices.swap(rest.vertices);
+            stack.back().first = rest.first;
+            stack.push_back(part());
+            stack.back().vertices = order;
+            stack.back().first = pt.first;
+            continue;
+        }
+        if(num_levels < 3) {
+            for(auto it=order.begin(); it!=order.end(); ++it)
+                level[*it] = -1;
+            std::copy(pt.vertices.begin(), pt.vertices.end(), perm.begin() + pt.first);
+            continue;
+        }
+
+        // the level holding the middle vertex separates the ones before it
+        // from the ones after, its vertices with no neighbor after it join
+        // the ones before
+        std::size_t sep = 1;
+        while(sep < num_levels-2 && level_begin[sep+1] <= order.size()/2)
+            sep++;
+        part low, high;
+        std::vector<std::int32_t> separator;
+        low.vertices.assign(order.begin(), order.begin() + level_begin[sep]);
+        high.vertices.assign(order.begin() + level_begin[sep+1], order.end());
+        for(std::size_t k=level_begin[sep]; k<level_begin[sep+1]; k++) {
+            std::int32_t v = order[k];
+            bool touches_high = false;
+            for(std::size_t a=adj_begin[v]; a<adj_begin[v+1] && !touches_high; a++)
+                touches_high = mark[adj[a]] == stamp && level[adj[a]] == (std::int32_t)sep+1;
+            if(touches_high)
+                separator.push_back(v);
+            else
+                low.vertices.push_back(v);
+        }
+        for(auto it=order.begin(); it!=order.end(); ++it)
+            level[*it] = -1;
+        low.first = pt.first;
+        high.first = low.first + low.vertices.size();
+        std::copy(separator.begin(), separator.end(), perm.begin() + high.first + high.vertices.size());
+        stack.push_back(part());
+        stack.back().vertices.swap(high.vertices);
+        stack.back().first = high.first;
+        stack.push_back(part());
+        stack.back().vertices.swap(low.vertices);
+        stack.back().first = low.first;
+    }
+}
+
+
+
+/* ============================================================================ *
+ * Sparse Cholesky
+ * ============================================================================ */
+bool physics::sparse_cholesky::factor(size_type size, const std::vector<entry>& lower, size_type max_entries) {
+    clear();
+    this->size = size;
+
+    // adjacency of A for the ordering, off-diagonal entries both ways
+    std::vector<size_type> adj_begin(size+1, 0);
+    for(auto it=lower.begin(); it!=lower.end(); ++it) {
+        if(it->row != it->column) {
+            adj_begin[it->row+1]++;
+            adj_begin[it->column+1]++;
+        }
+    }
+    for(size_type i=0; i<size; i++)
+        adj_begin[i+1] += adj_begin[i];
+    std::vector<std::int32_t> adj(adj_begin[size]);
+    {
+        std::vector<size_type> fill(adj_begin.begin(), adj_begin.end()-1);
+        for(auto it=lower.begin(); it!=lower.end(); ++it) {
+            if(it->row != it->column) {
+                adj[fill[it->row]++] = it->column;
+                adj[fill[it->column]++] = it->row;
+            }
+        }
+    }
+    nested_dissection(size, adj_begin, adj, perm);
+    inv_perm.resize(size);
+    for(size_type k=0; k<size; k++)
+        inv_perm[perm[k]] = (std::int32_t)k;
+
+    // permuted A, upper triangle by column
+    std::vector<size_type> a_begin(size+1, 0);
+    for(auto it=lower.begin(); it!=lower.end(); ++it)
+        a_begin[std::max(inv_perm[it->row], inv_perm[it->column])+1]++;
+    for(size_type k=0; k<size; k++)
+        a_begin[k+1] += a_begin[k];
+    std::vector<std::int32_t> a_row(a_begin[size]);
+    std::vector<double> a_value(a_begin[size]);
+    {
+        std::vector<size_type> fill(a_begin.begin(), a_begin.end()-1);
+        for(auto it=lower.begin(); it!=lower.end(); ++it) {
+            std::int32_t i = inv_perm[it->row], j = inv_perm[it->column];
+            size_type at = fill[std::max(i, j)]++;
+            a_row[at] = std::min(i, j);
+            a_value[at] = it->value;
+        }
+    }
+    adj.clear();
+    adj.shrink_to_fit();
+
+    // elimination tree, with path compressed ancestors
+    std::vector<std::int32_t> parent(size, -1);
+    {
+        std::vector<std::int32_t> ancestor(size, -1);
+        for(size_type k=0; k<size; k++) {
+            for(size_type a=a_begin[k]; a<a_begin[k+1]; a++) {
+                std::int32_t i = a_row[a];
+                while(i != -1 && i < (std::int32_t)k) {
+                    std::int32_t next = ancestor[i];
+                    ancestor[i] = (std::int32_t)k;
+                    if(next == -1)
+                        parent[i] = (std::int32_t)k;
+                    i = next;
+                }
+            }
+        }
+    }
+
+    // row k of L is the part of the tree that A's row k reaches, walked up
+    // to k; reach[top ... size-1] holds it in topological order
+    std::vector<std::int32_t> visited(size, -1);
+    std::vector<std::int32_t> reach(size);
+    std::vector<std::int32_t> path(size);
+    auto row_pattern = [&](size_type k) -> size_type {
+        size_type top = size;
+        visited[k] = (std::int32_t)k;
+        for(size_type a=a_begin[k]; a<a_begin[k+1]; a++) {
+            size_type len = 0;
+            for(std::int32_t i=a_row[a]; visited[i] != (std::int32_t)k; i=parent[i]) {
+                path[len++] = i;
+                visited[i] = (std::int32_t)k;
+            }
+            while(len > 0)
+                reach[--top] = path[--len];
+        }
+        return top;
+    };
+
+    // symbolic pass, column counts, refused as soon as they add up to more
+    // than max_entries
+    l_begin.assign(size+1, 0);
+    size_type num_entries = 0;
+    for(size_type k=0; k<size; k++) {
+        size_type top = row_pattern(k);
+        num_entries += size - top + 1;
+        if(num_entries > max_entries) {
+            clear();
+            return false;
+        }
+        l_begin[k+1]++;
+        for(; top<size; top++)
+            l_begin[reach[top]+1]++;
+    }
+    for(size_type k=0; k<size; k++)
+        l_begin[k+1] += l_begin[k];
+    l_row.resize(l_begin[size]);
+    l_value.resize(l_begin[size]);
+
+    // numeric pass, up-looking: row k of L is a sparse triangular solve
+    // against the rows before it
+    std::fill(visited.begin(), visited.end(), -1);
+    std::vector<size_type> next(l_begin.begin(), l_begin.end()-1);
+    std::vector<double> x(size, 0.0);
+    for(size_type k=0; k<size; k++) {
+        size_type top = row_pattern(k);
+        for(size_type a=a_begin[k]; a<a_begin[k+1]; a++)
+            x[a_row[a]] += a_value[a];
+        double d = x[k];
+        x[k] = 0.0;
+        for(; top<size; top++) {
+            std::int32_t i = reach[top];
+            double l_ki = x[i]/l_value[l_begin[i]];
+            x[i] = 0.0;
+            for(size_type a=l_begin[i]+1; a<next[i]; a++)
+                x[l_row[a]] -= l_value[a]*l_ki;
+            d -= l_ki*l_ki;
+            l_row[next[i]] = (std::int32_t)k;
+            l_value[next[i]++] = l_ki;
+        }
+        if(d <= 0) {
+            clear();
+            return false;
+        }
+        l_row[next[k]] = (std::int32_t)k;
+        l_value[next[k]++] = std::sqrt(d);
+    }
+    work.resize(3*size);
+    return true;
+}
+
+void physics::sparse_cholesky::clear() {
+    size = 0;
+    perm.clear();
+    inv_perm.clear();
+    l_begin.clear();
+    l_row.clear();
+    l_value.clear();
+    work.clear();
+}
+
+physics::sparse_cholesky::size_type physics::sparse_cholesky::num_entries() const {
+    return l_row.size();
+}
+
+void physics::sparse_cholesky::solve(std::vector<double>& xyz) {
+    for(size_type k=0; k<size; k++) {
+        work[3*k] = xyz[3*perm[k]];
+        work[3*k+1] = xyz[3*perm[k]+1];
+        work[3*k+2] = xyz[3*perm[k]+2];
+    }
+    // forward, L y = b, one finished column scattered at a time
+    for(size_type j=0; j<size; j++) {
+        double d = l_value[l_begin[j]];
+        double x = work[3*j] /= d;
+        double y = work[3*j+1] /= d;
+        double z = work[3*j+2] /= d;
+        for(size_type a=l_begin[j]+1; a<l_begin[j+1]; a++) {
+            size_type i = l_row[a];
+            work[3*i] -= l_value[a]*x;
+            work[3*i+1] -= l_value[a]*y;
+            work[3*i+2] -= l_value[a]*z;
+        }
+    }
+    // backward, L^T x = y, each column gathered
+    for(size_type j=size; j-- > 0;) {
+        double x = work[3*j], y = work[3*j+1], z = work[3*j+2];
+        for(size_type a=l_begin[j]+1; a<l_begin[j+1]; a++) {
+            size_type i = l_row[a];
+            x -= l_value[a]*work[3*i];
+            y -= l_value[a]*work[3*i+1];
+            z -= l_value[a]*work[3*i+2];
+        }
+        double d = l_value[l_begin[j]];
+        work[3*j] = x/d;
+        work[3*j+1] = y/d;
+        work[3*j+2] = z/d;
+    }
+    for(size_type k=0; k<size; k++) {
+        xyz[3*perm[k]] = work[3*k];
+        xyz[3*perm[k]+1] = work[3*k+1];
+        xyz[3*perm[k]+2] = work[3*k+2];
+    }
+}
+
+
+
+/* ============================================================================ *
+ * Projective System
+ * ============================================================================ */
+bool physics::projective_system::build(const particle_set& p, const std::vector<distance_constraint>& edges, float time_step) {
+    clear();
+    this->time_step = time_step;
+    size_type n = p.size();
+    try {
+        springs.reserve(edges.size());
+        for(auto it=edges.begin(); it!=edges.end(); ++it)
+            springs.push_back({it->a, it->b, it->rest_length, 1.0f/it->compliance});
+        inertia.resize(n);
+        for(size_type i=0; i<n; i++)
+            inertia[i] = 1.0/(p.inv_mass[i]*(double)time_step*time_step);
+
+        // pinned rows are the identity, their couplings move to the rhs
+        std::vector<sparse_cholesky::entry> lower;
+        lower.reserve(n + 3*springs.size());
+        for(size_type i=0; i<n; i++)
+            lower.push_back({(std::int32_t)i, (std::int32_t)i, p.is_pinned(i) ? 1.0 : inertia[i]});
+        for(auto it=springs.begin(); it!=springs.end(); ++it) {
+            bool free_a = !p.is_pinned(it->a);
+            bool free_b = !p.is_pinned(it->b);
+            if(free_a)
+                lower.push_back({(std::int32_t)it->a, (std::int32_t)it->a, it->weight});
+            if(free_b)
+                lower.push_back({(std::int32_t)it->b, (std::int32_t)it->b, it->weight});
+            if(free_a && free_b)
+                lower.push_back({(std::int32_t)std::max(it->a, it->b), (std::int32_t)std::min(it->a, it->b), -(double)it->weight});
+        }
+        target.resize(n);
+        rhs.resize(3*n);
+        if(!matrix.factor(n, lower, PROJECTIVE_MAX_FACTOR_ENTRIES)) {
+            clear();
+            return false;
+        }
+    }
+    catch(const std::bad_alloc&) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+void physics::projective_system::clear() {
+    springs.clear();
+    inertia.clear();
+    matrix.clear();
+    target.clear();
+    rhs.clear();
+}
+
+bool physics::projective_system::empty() const {
+    return matrix.size == 0;
+}
+
+void physics::projective_system::step(particle_set& p, const glm::vec3& a_gravity, const glm::vec3& f_wind, std::size_t iterations) {
+    size_type n = p.size();
+    float h = time_step;
+    // inertial target s = x + (x - x_old) + h^2*a, the starting guess
+    for(size_type i=0; i<n; i++) {
+        if(p.is_pinned(i)) {
+            target[i] = p.pos[i];
+            continue;
+        }
+        glm::vec3 a = a_gravity + f_wind*p.inv_mass[i];
+        target[i] = p.pos[i]*2.0f - p.pos_old[i] + a*(h*h);
+        p.pos_old[i] = p.pos[i];
+        p.pos[i] = target[i];
+    }
+    for(size_type k=0; k<iterations; k++) {
+        for(size_type i=0; i<n; i++) {
+            double m = p.is_pinned(i) ? 1.0 : inertia[i];
+            rhs[3*i] = m*target[i].x;
+            rhs[3*i+1] = m*target[i].y;
+            rhs[3*i+2] = m*target[i].z;
+        }
+        // local step, w L^T p (plus w*x for pinned neighbors)
+        for(auto it=springs.begin(); it!=springs.end(); ++it) {
+            glm::vec3 d = p.pos[it->a] - p.pos[it->b];
+            float len = glm::length(d);
+            glm::vec3 proj = len > 0 ? d*(it->rest_length/len) : glm::vec3(0);
+            bool free_a = !p.is_pinned(it->a);
+            bool free_b = !p.is_pinned(it->b);
+            if(free_a) {
+                glm::vec3 f = proj*it->weight;
+                if(!free_b)
+                    f += p.pos[it->b]*it->weight;
+                rhs[3*it->a] += f.x;
+                rhs[3*it->a+1] += f.y;
+                rhs[3*it->a+2] += f.z;
+            }
+            if(free_b) {
+                glm::vec3 f = -proj*it->weight;
+                if(!free_a)
+                    f += p.pos[it->a]*it->weight;
+                rhs[3*it->b] += f.x;
+                rhs[3*it->b+1] += f.y;
+                rhs[3*it->b+2] += f.z;
+            }
+        }
+        // global step
+        matrix.solve(rhs);
+        for(size_type i=0; i<n; i++) {
+            if(!p.is_pinned(i))
+                p.pos[i] = {(float)rhs[3*i], (float)rhs[3*i+1], (float)rhs[3*i+2]};
+        }
+    }
+}
@@ -0,0 +1,116 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: projective.h
+ *  Header file for the Projective Dynamics integrator
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: Projective Dynamics takes an implicit Euler step by alternating a
+ *  local step (every spring projects its current vector onto its rest
+ *  length) with a global step that solves
+ *      (M/h^2 + sum w L^T L) x = M/h^2 s + sum w L^T p,
+ *  s = x + h*v + h^2*a_ext the inertial target, L the difference operator of
+ *  a spring and p its projection. The matrix depends only on the masses, the
+ *  time step, the spring weights and the pins, so it is factored once
+ *  (sparse Cholesky, in double) and every iteration is a forward and a back
+ *  substitution. Pinned particles are removed from the system and act as
+ *  boundary values.
+ *  The factor is kept sparse by eliminating the particles in a nested
+ *  dissection order: a part of the spring graph is split by the middle level
+ *  of a breadth-first search from a far vertex, both halves are ordered
+ *  first (recursively) and the separating level last, so fill stays within
+ *  the halves and the separators. On the cloth grid that is O(N log N)
+ *  entries and an O(N^1.5) factorization, where the row by row band was
+ *  O(N^1.5) entries and O(N^2) work. Factors that would exceed
+ *  PROJECTIVE_MAX_FACTOR_ENTRIES are refused after the symbolic pass, before
+ *  anything is allocated for them.
+ * ---------------------------------------------------------------------------- */
+
+#ifndef PROJECTIVE_H
+#define PROJECTIVE_H
+
+#include "../../lib/glm/vec3.hpp"
+
+#include "particles.h"
+#include "constraints.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace physics {
+    // static constants
+    // - entries of the cholesky factor at most, about 12 bytes each
+    const std::size_t PROJECTIVE_MAX_FACTOR_ENTRIES = std::size_t(1) << 27;
+
+    // sparse symmetric positive definite matrix and its cholesky factor,
+    // in a fill-reducing order
+    struct sparse_cholesky {
+        // typedefs
+        typedef std::size_t size_type;
+
+        // entry of the lower triangle (row >= column), duplicates are summed
+        struct entry {
+            std::int32_t row;
+            std::int32_t column;
+            double value;
+        };
+
+        size_type size;
+        // - perm[k] is the row eliminated k-th, inv_perm its inverse
+        std::vector<std::int32_t> perm;
+        std::vector<std::int32_t> inv_perm;
+        // - column k of L is l_row/l_value[l_begin[k] ... l_begin[k+1]-1],
+        //   the diagonal first, in elimination order
+        std::vector<size_type> l_begin;
+        std::vector<std::int32_t> l_row;
+        std::vector<double> l_value;
+        // - solve scratch, permuted xyz
+        std::vector<double> work;
+
+        // - orders and factors A, returns false if A was not positive
+        //   definite or its factor would have more than max_entries entries
+        bool factor(size_type size, const std::vector<entry>& lower, size_type max_entries);
+        void clear();
+        size_type num_entries() const;
+        // - solves A x = b in place for 3 interleaved right hand sides
+        void solve(std::vector<double>& xyz);
+    };
+
+    struct projective_system {
+        // typedefs
+        typedef std::size_t size_type;
+
+        struct spring {
+            size_type a;
+            size_type b;
+            float rest_length;
+            float weight;
+        };
+
+        std::vector<spring> springs;
+        std::vector<double> inertia; // m/h^2, per particle
+        float time_step;
+        sparse_cholesky matrix;
+        // - step scratch, inertial targets and the interleaved xyz rhs
+        std::vector<glm::vec3> target;
+        std::vector<double> rhs;
+
+        // - springs weigh 1/compliance, inactive edges must be left out
+        //   and pinned particles stay pinned until the next build
+        // - false, and empty, if the system cannot be factored (or its
+        //   factor does not fit)
+        bool build(const particle_set& p, const std::vector<distance_constraint>& edges, float time_step);
+        void clear();
+        bool empty() const;
+
+        // - one implicit step of `iterations` local/global iterations from
+        //   the verlet state (pos, pos_old), pinned particles never move
+        void step(particle_set& p, const glm::vec3& a_gravity, const glm::vec3& f_wind, std::size_t iterations);
+    };
+}
+
+#endif
@@ -0,0 +1,219 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: self_collision.cpp
+ *  Definition file for particle-particle self-collision over a spatial hash
+ * **************************************************************************** */
+
+#include "self_collision.h"
+
+#include <algorithm>
+#include <cmath>
+
+/* ============================================================================ *
+ * Static Constant Definitions
+ * ============================================================================ */
+const physics::spatial_hash::size_type
+physics::spatial_hash::MIN_TABLE_SIZE;
+
+
+
+/* ============================================================================ *
+ * Spatial Hash
+ * ============================================================================ */
+void physics::spatial_hash::clear() {
+    cell_start.clear();
+    occupied.clear();
+    entries.clear();
+    entry_pos.clear();
+    member_bucket.clear();
+    histogram.clear();
+    range_total.clear();
+}
+
+void physics::spatial_hash::build(const particle_set& p, const std::vector<size_type>& members, float cell, ThreadPool& pool) {
+    cell_size = cell;
+    size_type n = members.size();
+    size_type table = MIN_TABLE_SIZE;
+    while(table < 2*n)
+        table <<= 1;
+    mask = (std::uint32_t)(table - 1);
+    size_type num_words = table/32;
+    cell_start.resize(table+1);
+    occupied.resize(num_words);
+    entries.resize(n);
+    entry_pos.resize(n);
+    member_bucket.resize(n);
+    histogram.resize(pool.size()*table);
+    range_total.resize(pool.size());
+    pool.run([&](std::size_t thread, std::size_t num_threads) {
+        // count this thread's share of the members
+        std::uint32_t* row = &histogram[thread*table];
+        std::fill(row, row+table, 0);
+        size_type begin = n*thread/num_threads;
+        size_type end = n*(thread+1)/num_threads;
+        for(size_type k=begin; k<end; k++) {
+            std::uint32_t b = bucket(p.pos[members[k]]);
+            member_bucket[k] = b;
+            row[b]++;
+        }
+        pool.barrier();
+        // scan a range of buckets, thread-major within a bucket, so each
+        // histogram entry becomes its thread's first slot in the bucket
+        // - whole occupancy words per thread
+        size_type b_begin = 32*(num_words*thread/num_threads);
+        size_type b_end = 32*(num_words*(thread+1)/num_threads);
+        std::uint32_t running = 0;
+        for(size_type b=b_begin; b<b_end; b++) {
+            cell_start[b] = running;
+            for(size_type t=0; t<num_threads; t++) {
+                std::uint32_t& h = histogram[t*table + b];
+                std::uint32_t count = h;
+                h = running;
+                running += count;
+            }
+            if(b%32 == 0)
+                occupied[b/32] = 0;
+            if(running != cell_start[b])
+                occupied[b/32] |= 1u << (b%32);
+        }
+        range_total[thread] = running;
+        pool.barrier();
+        // offset by the ranges before this one
+        std::uint32_t base = 0;
+        for(size_type t=0; t<thread; t++)
+            base += range_total[t];
+        for(size_type b=b_begin; b<b_end; b++) {
+            cell_start[b] += base;
+            for(size_type t=0; t<num_threads; t++)
+                histogram[t*table + b] += base;
+        }
+        if(thread == num_threads-1)
+            cell_start[table] = base + running;
+        pool.barrier();
+        // scatter, in member order within each thread
+        for(size_type k=begin; k<end; k++) {
+            std::uint32_t slot = row[member_bucket[k]]++;
+            entries[slot] = (std::int32_t)members[k];
+            entry_pos[slot] = p.pos[members[k]];
+        }
+    });
+}
+
+std::uint32_t physics::spatial_hash::bucket(int x, int y, int z) const {
+    return (((std::uint32_t)x*73856093u) ^ ((std::uint32_t)y*19349663u) ^ ((std::uint32_t)z*83492791u)) & mask;
+}
+
+std::uint32_t physics::spatial_hash::bucket(const glm::vec3& pos) const {
+    return bucket((int)std::floor(pos.x/cell_size), (int)std::floor(pos.y/cell_size), (int)std::floor(pos.z/cell_size));
+}
+
+
+
+/* ============================================================================ *
+ * Self Collision Set
+ * ============================================================================ */
+// lower of the two cells within half a cell of coordinate f (in cells)
+static int first_cell(float f) {
+    float fl = std::floor(f);
+    return (int)fl - (f - fl < 0.5f ? 1 : 0);
+}
+
+void physics::self_collision_set::clear() {
+    members.clear();
+    hash.clear();
+    contacts.clear();
+    thread_contacts.clear();
+}
+
+void physics::self_collision_set::build(const std::vector<size_type>& colliding) {
+    members = colliding;
+}
+
+physics::self_collision_set::size_type physics::self_collision_set::find_contacts(const particle_set& p, float thickness, const adjacency_test& adjacent, ThreadPool& pool, const island_set* islands) {
+    // cells twice the thickness, so any particle within it is in one of
+    // two cells along each axis
+    float cell = 2.0f*thickness;
+    hash.build(p, members, cell, pool);
+    float thickness_2 = thickness*thickness;
+    thread_contacts.resize(pool.size());
+    pool.run([&](std::size_t thread, std::size_t num_threads) {
+        std::vector<contact>& out = thread_contacts[thread];
+        out.clear();
+        size_type n = members.size();
+        for(size_type k=n*thread/num_threads; k<n*(thread+1)/num_threads; k++) {
+            size_type i = members[k];
+            const glm::vec3& pos = p.pos[i];
+            bool i_asleep = islands && islands->is_asleep(i);
+            // the 2x2x2 cells on the particle's side of each axis
+            int x = first_cell(pos.x/cell);
+            int y = first_cell(pos.y/cell);
+            int z = first_cell(pos.z/cell);
+            // neighboring cells may share a bucket, visit each bucket once
+            std::uint32_t visited[8];
+            unsigned num_visited = 0;
+            for(int dz=0; dz<=1; dz++) {
+                for(int dy=0; dy<=1; dy++) {
+                    for(int dx=0; dx<=1; dx++) {
+                        std::uint32_t b = hash.bucket(x+dx, y+dy, z+dz);
+                        if(!hash.is_occupied(b))
+                            continue;
+                        if(std::find(visited, visited+num_visited, b) != visited+num_visited)
+                            continue;
+                        visited[num_visited++] = b;
+                        for(std::uint32_t e=hash.cell_start[b]; e<hash.cell_start[b+1]; e++) {
+                            size_type j = hash.entries[e];
+                            if(j <= i)
+                                continue;
+                            glm::vec3 d = hash.entry_pos[e] - pos;
+                            if(d.x*d.x + d.y*d.y + d.z*d.z >= thickness_2)
+                                continue;
+                            if(i_asleep && islands->is_asleep(j))
+                                continue;
+                            if(adjacent(i, j))
+                                continue;
+                            out.push_back({(std::int32_t)i, (std::int32_t)j});
+                        }
+                    }
+                }
+            }
+        }
+    });
+    // merged in thread order, which is member order
+    contacts.clear();
+    for(auto it=thread_contacts.begin(); it!=thread_contacts.end(); ++it)
+        contacts.insert(contacts.end(), it->begin(), it->end());
+    return contacts.size();
+}
+
+
+
+/* ============================================================================ *
+ * Self Collision Solve
+ * ============================================================================ */
+std::size_t physics::solve_self_collisions(particle_set& p, const self_collision_set& s, float thickness, std::size_t iterations) {
+    float thickness_2 = thickness*thickness;
+    std::size_t count_resolved = 0;
+    for(std::size_t iter=0; iter<iterations; iter++) {
+        for(auto it=s.contacts.begin(); it!=s.contacts.end(); ++it) {
+            glm::vec3 d = p.pos[it->b] - p.pos[it->a];
+            float d_length_2 = d.x*d.x + d.y*d.y + d.z*d.z;
+            // coincident particles have no direction to separate along
+            if(d_length_2 >= thickness_2 || d_length_2 == 0.0f)
+                continue;
+            float w_a = p.weight(it->a);
+            float w_b = p.weight(it->b);
+            float w_sum = w_a + w_b;
+            if(w_sum == 0.0f)
+                continue;
+            float d_length = std::sqrt(d_length_2);
+            float s_push = (thickness - d_length) / (d_length*w_sum);
+            p.pos[it->a] -= d*(s_push*w_a);
+            p.pos[it->b] += d*(s_push*w_b);
+            count_resolved++;
+        }
+    }
+    return count_resolved;
+}
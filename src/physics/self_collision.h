@@ -0,0 +1,121 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: self_collision.h
+ *  Header file for particle-particle self-collision over a spatial hash
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: Every particle is treated as a sphere of diameter `thickness`. The
+ *  spatial hash has cells of twice that size hashed into a table of at
+ *  least twice the particle count, so any particle closer than the
+ *  thickness sits in one of the 2x2x2 cells on its neighbor's side of each
+ *  axis, and a bitmask of the occupied buckets (small enough to stay
+ *  cached) skips most of those lookups. The table is rebuilt from
+ *  scratch each substep by a counting sort split across the pool: each
+ *  thread counts its share of particles into a histogram of its own, the
+ *  histograms are scanned per bucket range, and each thread scatters its
+ *  share again. The sort is stable, so the table (and with it the contact
+ *  list) does not depend on the thread count.
+ *  Pairs joined by an edge (including diagonal and bending ones) already
+ *  keep their distance and are excluded, by asking the owner's own edge
+ *  adjacency about each close pair (there are few of them, so no copy of
+ *  it is kept here); on the rest grid every other pair
+ *  is at least sqrt(5) spacings apart, so a thickness below that never
+ *  pushes an untouched cloth. Contacts are projected Gauss-Seidel style in
+ *  contact order, like the plane collision.
+ * ---------------------------------------------------------------------------- */
+
+#ifndef SELF_COLLISION_H
+#define SELF_COLLISION_H
+
+#include "../../lib/glm/vec3.hpp"
+
+#include "particles.h"
+#include "islands.h"
+#include "aligned_allocator.h"
+#include "thread_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace physics {
+    struct spatial_hash {
+        // typedefs
+        typedef std::size_t size_type;
+
+        // static constants
+        static const size_type MIN_TABLE_SIZE = 64;
+
+        float cell_size;
+        std::uint32_t mask; // table size - 1
+        // the particles in bucket b are entries[cell_start[b] ... cell_start[b+1]-1],
+        // ascending, with their positions at the time of the build
+        std::vector<std::uint32_t> cell_start;
+        // - one bit per bucket, set if it holds any particle
+        std::vector<std::uint32_t> occupied;
+        std::vector<std::int32_t> entries;
+        aligned_vector<glm::vec3> entry_pos;
+        // scratch, bucket of each member and one histogram row per thread
+        std::vector<std::uint32_t> member_bucket;
+        std::vector<std::uint32_t> histogram;
+        std::vector<std::uint32_t> range_total;
+
+        // container manipulation
+        void clear();
+        // - hashes the given particles (ascending) at their current positions
+        void build(const particle_set& p, const std::vector<size_type>& members, float cell, ThreadPool& pool);
+
+        // lookup
+        std::uint32_t bucket(int x, int y, int z) const;
+        std::uint32_t bucket(const glm::vec3& pos) const;
+        bool is_occupied(std::uint32_t b) const;
+    };
+
+    struct self_collision_set {
+        // typedefs
+        typedef std::size_t size_type;
+        // - whether two particles share an edge, called from every thread
+        typedef std::function<bool(size_type, size_type)> adjacency_test;
+
+        struct contact {
+            std::int32_t a;
+            std::int32_t b;
+        };
+
+        // particles that collide, ascending
+        std::vector<size_type> members;
+        spatial_hash hash;
+        // contacts of the last find_contacts(), a < b
+        std::vector<contact> contacts;
+        std::vector<std::vector<contact>> thread_contacts;
+
+        // container manipulation
+        void clear();
+        // - the colliding particles
+        void build(const std::vector<size_type>& members);
+
+        // collision
+        // - rehashes the members and lists every pair closer than thickness
+        //   that is not adjacent, skipping pairs that are both asleep in
+        //   islands (if given)
+        // - returns the number of contacts
+        size_type find_contacts(const particle_set& p, float thickness, const adjacency_test& adjacent, ThreadPool& pool, const island_set* islands=nullptr);
+    };
+
+    // inline accessors (used by the contact search)
+    inline bool spatial_hash::is_occupied(std::uint32_t b) const {
+        return (occupied[b/32] >> (b%32)) & 1u;
+    }
+
+    // - pushes the particles of every contact apart to the thickness,
+    //   weighted by inverse mass, `iterations` times over the contact list
+    // - returns the number of contacts that were resolved
+    std::size_t solve_self_collisions(particle_set& p, const self_collision_set& s, float thickness, std::size_t iterations);
+}
+
+#endif
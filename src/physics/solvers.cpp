@@ -0,0 +1,76 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: solvers.cpp
+ *  Definition file for the constraint sweep strategies built on the kernels
+ * **************************************************************************** */
+
+#include "solvers.h"
+
+#include "constraint_kernel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+/* ============================================================================ *
+ * Colored Sweep
+ * ============================================================================ */
+std::size_t physics::solve_colored_sweep(particle_set& p, const constraint_set& c, ThreadPool& pool, xpbd_multipliers* m, constraint_error* err) {
+    // resolve the kernel before the workers race to do so
+    get_kernel_isa();
+    std::atomic<std::size_t> count_resolved(0);
+    std::vector<constraint_error> thread_err(err ? pool.size() : 0);
+    for(auto it=thread_err.begin(); it!=thread_err.end(); ++it)
+        it->clear();
+    pool.run([&](std::size_t thread, std::size_t num_threads) {
+        std::size_t count = 0;
+        constraint_error* t_err = err ? &thread_err[thread] : nullptr;
+        for(std::size_t k=0; k<c.num_groups(); k++) {
+            // static split of the color's batches
+            std::size_t begin = c.group_begin[k];
+            std::size_t batches = (c.group_begin[k+1] - begin)/BATCH_WIDTH;
+            std::size_t b = begin + batches*thread/num_threads*BATCH_WIDTH;
+            std::size_t e = begin + batches*(thread+1)/num_threads*BATCH_WIDTH;
+            count += solve_constraints(p, c, m, b, e, t_err);
+            // the next color may touch any particle of this one
+            pool.barrier();
+        }
+        count_resolved.fetch_add(count, std::memory_order_relaxed);
+    });
+    for(auto it=thread_err.begin(); it!=thread_err.end(); ++it)
+        err->merge(*it);
+    return count_resolved.load();
+}
+
+
+
+/* ============================================================================ *
+ * Tiled Sweeps
+ * ============================================================================ */
+std::size_t physics::solve_tiled(particle_set& p, const constraint_set& tiles, const constraint_set& tiles_offset, std::size_t iterations, std::size_t local_iterations, xpbd_multipliers* m, constraint_error* err) {
+    std::size_t count_resolved = 0;
+    bool offset = false;
+    while(iterations > 0) {
+        const constraint_set& c = offset ? tiles_offset : tiles;
+        std::size_t local = std::min(iterations, local_iterations);
+        iterations -= local;
+        // only the last pass reports its error
+        count_resolved += solve_tiled_pass(p, c, local, m, iterations == 0 ? err : nullptr);
+        offset = !offset;
+    }
+    return count_resolved;
+}
+
+std::size_t physics::solve_tiled_pass(particle_set& p, const constraint_set& tiles, std::size_t local_iterations, xpbd_multipliers* m, constraint_error* err) {
+    std::size_t count_resolved = 0;
+    for(std::size_t t=0; t<tiles.num_groups(); t++) {
+        for(std::size_t i=0; i<local_iterations; i++) {
+            count_resolved += solve_constraints(p, tiles, m, tiles.group_begin[t], tiles.group_begin[t+1],
+                i+1 == local_iterations ? err : nullptr);
+        }
+    }
+    return count_resolved;
+}
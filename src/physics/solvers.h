@@ -0,0 +1,44 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: solvers.h
+ *  Header file for the constraint sweep strategies built on the kernels
+ * **************************************************************************** */
+
+#ifndef SOLVERS_H
+#define SOLVERS_H
+
+#include "particles.h"
+#include "constraints.h"
+#include "constraint_kernel.h"
+#include "thread_pool.h"
+
+#include <cstddef>
+
+namespace physics {
+    // every strategy projects with the xpbd kernels if given multipliers,
+    // otherwise with the flex band ones (see constraint_kernel.h), and
+    // accumulates the error of its last sweep into err if given
+
+    // colored sweep
+    // - solves one color at a time, each color split evenly across the pool
+    // - requires a constraint set built by build_colored()
+    // - per-thread errors are merged in thread order
+    std::size_t solve_colored_sweep(particle_set& p, const constraint_set& c, ThreadPool& pool, xpbd_multipliers* m=nullptr, constraint_error* err=nullptr);
+
+    // tiled sweeps
+    // - runs `iterations` sweeps as passes over the tiles, each tile sweeping
+    //   its constraints up to `local_iterations` times while they are cached
+    // - passes alternate between two tilings offset by half a tile, so the
+    //   borders of one tiling are swept as interiors of the other
+    // - requires constraint sets built by build_tiled()
+    // - returns the number of constraints resolved over all sweeps
+    std::size_t solve_tiled(particle_set& p, const constraint_set& tiles, const constraint_set& tiles_offset, std::size_t iterations, std::size_t local_iterations, xpbd_multipliers* m=nullptr, constraint_error* err=nullptr);
+    // - a single pass over one tiling, the error is that of each tile's last
+    //   local sweep
+    std::size_t solve_tiled_pass(particle_set& p, const constraint_set& tiles, std::size_t local_iterations, xpbd_multipliers* m=nullptr, constraint_error* err=nullptr);
+}
+
+#endif
@@ -0,0 +1,150 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: thread_pool.cpp
+ *  Definition file for ThreadPool class
+ * **************************************************************************** */
+
+#include "thread_pool.h"
+
+/* ============================================================================ *
+ * Static Constant Definitions
+ * ============================================================================ */
+const ThreadPool::size_type
+ThreadPool::SPIN_COUNT
+    = 4096;
+
+
+/* ============================================================================ *
+ * Constructors
+ * ============================================================================ */
+ThreadPool::ThreadPool(size_type num_threads)
+    : _threads()
+    , _mutex()
+    , _wake()
+    , _job(nullptr)
+    , _generation(0)
+    , _remaining(0)
+    , _stopping(false)
+    , _barrier_count(0)
+    , _barrier_generation(0)
+{
+    _start(num_threads > 1 ? num_threads-1 : 0);
+}
+
+// destructor
+ThreadPool::~ThreadPool() {
+    _stop();
+}
+
+
+
+/* ============================================================================ *
+ * Accessors
+ * ============================================================================ */
+ThreadPool::size_type ThreadPool::size() const {
+    return _threads.size() + 1;
+}
+
+
+
+/* ============================================================================ *
+ * Mutators
+ * ============================================================================ */
+void ThreadPool::resize(size_type num_threads) {
+    if(num_threads < 1)
+        num_threads = 1;
+    if(num_threads == size())
+        return;
+    _stop();
+    _start(num_threads-1);
+}
+
+
+
+/* ============================================================================ *
+ * Execution
+ * ============================================================================ */
+void ThreadPool::run(const job& fn) {
+    if(_threads.empty()) {
+        fn(0, 1);
+        return;
+    }
+    _job = &fn;
+    _remaining.store(_threads.size(), std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _generation.fetch_add(1, std::memory_order_release);
+    }
+    _wake.notify_all();
+    fn(0, size());
+    while(_remaining.load(std::memory_order_acquire) != 0)
+        std::this_thread::yield();
+    _job = nullptr;
+}
+
+void ThreadPool::barrier() {
+    size_type n = size();
+    if(n == 1)
+        return;
+    size_type gen = _barrier_generation.load(std::memory_order_acquire);
+    if(_barrier_count.fetch_add(1, std::memory_order_acq_rel) + 1 == n) {
+        // last thread in releases the others
+        _barrier_count.store(0, std::memory_order_relaxed);
+        _barrier_generation.fetch_add(1, std::memory_order_release);
+    }
+    else {
+        while(_barrier_generation.load(std::memory_order_acquire) == gen)
+            std::this_thread::yield();
+    }
+}
+
+
+
+/* ============================================================================ *
+ * Private Functions
+ * ============================================================================ */
+void ThreadPool::_start(size_type num_workers) {
+    _stopping.store(false);
+    // workers wait for the generation after this one
+    size_type gen = _generation.load(std::memory_order_acquire);
+    _threads.reserve(num_workers);
+    for(size_type i=0; i<num_workers; i++)
+        _threads.push_back(std::thread(&ThreadPool::_worker, this, i+1, gen));
+}
+
+void ThreadPool::_stop() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping.store(true);
+    }
+    _wake.notify_all();
+    for(auto it=_threads.begin(); it!=_threads.end(); ++it)
+        it->join();
+    _threads.clear();
+}
+
+void ThreadPool::_worker(size_type thread, size_type seen) {
+    while(true) {
+        // spin briefly before going to sleep
+        size_type gen = seen;
+        for(size_type spin=0; spin<SPIN_COUNT && gen == seen && !_stopping.load(); spin++) {
+            std::this_thread::yield();
+            gen = _generation.load(std::memory_order_acquire);
+        }
+        if(gen == seen) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wake.wait(lock, [&]() {
+                return _generation.load(std::memory_order_acquire) != seen || _stopping.load();
+            });
+            gen = _generation.load(std::memory_order_acquire);
+        }
+        if(_stopping.load())
+            return;
+        seen = gen;
+        (*_job)(thread, size());
+        _remaining.fetch_sub(1, std::memory_order_release);
+    }
+}
@@ -0,0 +1,80 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: thread_pool.h
+ *  Header file for ThreadPool class
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: run() executes the same job on every thread of the pool (the calling
+ *  thread takes part as thread 0) and returns once all of them finished. Jobs
+ *  split their work statically by thread index and synchronize phases with
+ *  barrier(). Workers spin for a short while before sleeping, so back-to-back
+ *  runs (one per solver sweep) do not pay for a wake-up each time.
+ * ---------------------------------------------------------------------------- */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // typedefs
+    typedef std::size_t size_type;
+    typedef std::function<void(size_type thread, size_type num_threads)> job;
+
+    // static constants
+    static const size_type SPIN_COUNT;
+
+private:
+    // private data members
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    const job* _job;
+    std::atomic<size_type> _generation;
+    std::atomic<size_type> _remaining;
+    std::atomic<bool> _stopping;
+    // - barrier state
+    std::atomic<size_type> _barrier_count;
+    std::atomic<size_type> _barrier_generation;
+
+public:
+    // constructors
+    explicit ThreadPool(size_type num_threads=1);
+    ThreadPool(const ThreadPool& o) = delete;
+
+    // assignment
+    ThreadPool& operator=(const ThreadPool& o) = delete;
+
+    // destructor
+    ~ThreadPool();
+
+    // accessors
+    // - total thread count, including the calling thread
+    size_type size() const;
+
+    // mutators
+    void resize(size_type num_threads);
+
+    // execution
+    void run(const job& fn);
+    void barrier();
+
+private:
+    // private functions
+    void _start(size_type num_workers);
+    void _stop();
+    void _worker(size_type thread, size_type seen);
+};
+
+#endif
@@ -0,0 +1,177 @@
+/* **************************************************************************** *
+ * AUTHOR:      Noah Krim
+ * ASSIGNMENT:  GUI Cloth Sim
+ * CLASS:       CS_08
+ * ---------------------------------------------------------------------------- *
+ * File: main.cpp
+ *  Headless regression check of ClothSim's determinism
+ * **************************************************************************** */
+
+/* ---------------------------------------------------------------------------- *
+ * NOTE: Every case restarts a small cloth, runs it for a fixed number of steps
+ *  and hashes the final state (the bits of every position plus the active
+ *  flag of every vertex and edge). A case is run once per thread count in
+ *  THREAD_COUNTS and once more single threaded, and checks that
+ *   - the repeated single threaded run reproduces the first one exactly,
+ *   - every thread count reproduces the single threaded hash exactly (the
+ *     solvers, tearing and self-collision all claim to be independent of the
+ *     thread count),
+ *   - every strategy keeps every position finite and within MAX_EXTENT
+ *     (relative to the cloth's scale) of the rest cloth's center. The
+ *     strategies converge differently and tearing is chaotic, so their
+ *     states are only bounded, not compared.
+ *  3 threads split the cloth unevenly. The hashes depend on the compiler and
+ *  instruction set, so they are only compared within one run, never against
+ *  recorded values. Prints one line per case and exits with 1 if any check
+ *  fails.
+ * ---------------------------------------------------------------------------- */
+
+#include "../physics/cloth_sim.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+typedef ClothSim::size_type size_type;
+
+// global constants
+const size_type THREAD_COUNTS[] = {3, 4};
+const size_type THREAD_COUNT_COUNT = sizeof(THREAD_COUNTS)/sizeof(THREAD_COUNTS[0]);
+const size_type CLOTH_N = 32;
+const size_type STEPS = 90;
+const float CLOTH_SCALE = 2.0f;
+const float MAX_EXTENT = 1.5f;
+const std::uint64_t FNV_OFFSET = 14695981039346656037ull;
+const std::uint64_t FNV_PRIME = 1099511628211ull;
+
+const char* const STRATEGY_NAMES[] = {
+    "GaussSeidel", "Colored", "Tiled", "Multigrid", "Jacobi"
+};
+const size_type STRATEGY_COUNT = sizeof(STRATEGY_NAMES)/sizeof(STRATEGY_NAMES[0]);
+
+// structs
+struct regress_scenario {
+    const char* name;
+    ClothSim::FixedPointArrangement fpa;
+    bool tearing;
+    bool self_collision;
+};
+struct regress_state {
+    std::uint64_t hash;
+    float extent; // farthest distance from the rest center
+    size_type active_edges;
+    bool finite;
+};
+
+// - drape: pinned corners swinging in, tear: a cut across the middle that
+//   tears further under its own weight, fold: a loose cloth dropped onto
+//   itself and the floor
+const regress_scenario SCENARIOS[] = {
+    {"drape", ClothSim::FourCorners, false, false},
+    {"tear",  ClothSim::Curtain,     true,  false},
+    {"fold",  ClothSim::Loose,       false, true}
+};
+const size_type SCENARIO_COUNT = sizeof(SCENARIOS)/sizeof(SCENARIOS[0]);
+
+
+
+/* ============================================================================ *
+ * Simulation
+ * ============================================================================ */
+void hash_word(std::uint64_t& h, std::uint32_t word) {
+    h ^= word;
+    h *= FNV_PRIME;
+}
+
+regress_state hash_state(const ClothSim& sim) {
+    regress_state state;
+    state.hash = FNV_OFFSET;
+    state.extent = 0;
+    state.active_edges = sim.get_num_active_edges();
+    state.finite = true;
+    glm::vec3 center(0.5f*CLOTH_SCALE, -0.5f*CLOTH_SCALE, 0);
+    const physics::particle_set& p = sim.get_particles();
+    const std::vector<ClothSim::cloth_vertex>& vertices = sim.get_vertices();
+    for(size_type i=0; i<p.size(); i++) {
+        std::uint32_t bits[3];
+        std::memcpy(bits, &p.pos[i], sizeof(bits));
+        for(size_type k=0; k<3; k++) {
+            hash_word(state.hash, bits[k]);
+            state.finite = state.finite && std::isfinite(p.pos[i][k]);
+        }
+        hash_word(state.hash, vertices[i].active);
+        state.extent = std::max(state.extent, glm::length(p.pos[i] - center));
+    }
+    const std::vector<ClothSim::cloth_edge>& edges = sim.get_edges();
+    for(auto it=edges.begin(); it!=edges.end(); ++it)
+        hash_word(state.hash, it->active);
+    return state;
+}
+
+regress_state run_case(const regress_scenario& scenario, ClothSim::SolverStrategy strategy, size_type threads) {
+    ClothSim sim(CLOTH_SCALE, CLOTH_N);
+    sim.set_num_threads(threads);
+    sim.set_solver_strategy(strategy);
+    sim.set_fixed_point_arrangement(scenario.fpa);
+    sim.set_tearing(scenario.tearing);
+    sim.set_self_collision(scenario.self_collision);
+    sim.restart();
+    if(scenario.tearing) {
+        // cut the middle row from the left edge to the center
+        size_type row = CLOTH_N/2;
+        for(size_type c=0; c<CLOTH_N/2; c++)
+            sim.erase_vertex(row*CLOTH_N + c);
+    }
+    for(size_type i=0; i<STEPS; i++)
+        sim.update_physics();
+    return hash_state(sim);
+}
+
+
+
+/* ============================================================================ *
+ * Main
+ * ============================================================================ */
+int main() {
+    size_type failures = 0;
+    char hex[17];
+    for(size_type sc=0; sc<SCENARIO_COUNT; sc++) {
+        const regress_scenario& scenario = SCENARIOS[sc];
+        for(size_type s=0; s<STRATEGY_COUNT; s++) {
+            ClothSim::SolverStrategy strategy = (ClothSim::SolverStrategy)s;
+            regress_state base = run_case(scenario, strategy, 1);
+            std::string failed;
+            if(run_case(scenario, strategy, 1).hash != base.hash)
+                failed += " repeat";
+            for(size_type t=0; t<THREAD_COUNT_COUNT; t++) {
+                if(run_case(scenario, strategy, THREAD_COUNTS[t]).hash != base.hash)
+                    failed += " threads=" + std::to_string(THREAD_COUNTS[t]);
+            }
+            if(!base.finite || base.extent > MAX_EXTENT*CLOTH_SCALE)
+                failed += " extent";
+
+            std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)base.hash);
+            cout << scenario.name << " " << STRATEGY_NAMES[s]
+                 << ": hash " << hex
+                 << " edges " << base.active_edges
+                 << " extent " << base.extent/CLOTH_SCALE
+                 << (failed.empty() ? " ok" : " FAILED:" + failed) << endl;
+            failures += !failed.empty();
+        }
+    }
+    if(failures) {
+        cerr << failures << " case(s) failed" << endl;
+        return 1;
+    }
+    cout << "all cases passed" << endl;
+    return 0;
+}